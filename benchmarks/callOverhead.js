@@ -0,0 +1,90 @@
+// Measures the per-call overhead of cheap sheet, format and font methods.
+// The cases taking a format or font also cover unwrapping of arguments.
+//
+// Usage: node benchmarks/callOverhead.js [iterations]
+
+var xl = require('../lib/libxl');
+
+var iterations = parseInt(process.argv[2], 10) || 1000000,
+    book = new xl.Book(xl.BOOK_TYPE_XLSX),
+    sheet = book.addSheet('bench'),
+    format = book.addFormat(),
+    font = book.addFont(),
+    cases = {};
+
+sheet.setMerge(0, 2, 5, 6);
+
+cases['sheet.writeNum'] = function(i) {
+    sheet.writeNum(i & 0xff, 0, i);
+};
+
+cases['sheet.writeNum with format'] = function(i) {
+    sheet.writeNum(i & 0xff, 0, i, format);
+};
+
+cases['sheet.writeStr'] = function(i) {
+    sheet.writeStr(i & 0xff, 1, 'Zürich');
+};
+
+cases['sheet.readNum'] = function(i) {
+    sheet.readNum(i & 0xff, 0);
+};
+
+cases['sheet.readCellInto'] = (function() {
+    var target = {},
+        options = {withFormat: true, withDate: true};
+
+    return function(i) {
+        sheet.readCellInto(i & 0xff, 0, target, options);
+    };
+})();
+
+cases['sheet.cellType'] = function(i) {
+    sheet.cellType(i & 0xff, 0);
+};
+
+cases['sheet.addrToRowCol'] = function() {
+    sheet.addrToRowCol('C5');
+};
+
+cases['sheet.getMerge'] = function() {
+    sheet.getMerge(0, 5);
+};
+
+cases['book.dateUnpack'] = function() {
+    book.dateUnpack(45000.5);
+};
+
+cases['format.wrap'] = function() {
+    format.wrap();
+};
+
+cases['format.setFont'] = function() {
+    format.setFont(font);
+};
+
+cases['font.size'] = function() {
+    font.size();
+};
+
+function measure(fn) {
+    var i, start, elapsed;
+
+    // Warm up the JIT before timing
+    for (i = 0; i < 10000; i++) fn(i);
+
+    start = process.hrtime();
+    for (i = 0; i < iterations; i++) fn(i);
+    elapsed = process.hrtime(start);
+
+    return (elapsed[0] * 1e9 + elapsed[1]) / iterations;
+}
+
+console.log(iterations + ' iterations per case');
+
+Object.keys(cases).forEach(function(name) {
+    var nsPerCall = measure(cases[name]);
+
+    console.log(name + ': ' + nsPerCall.toFixed(1) + ' ns / call, ' +
+        Math.round(1e9 / nsPerCall) + ' calls / s');
+});
@@ -12,7 +12,16 @@
         'src/font.cc',
         'src/book_wrapper.cc',
         'src/string_copy.cc',
-        'src/buffer_copy.cc'
+        'src/buffer_copy.cc',
+        'src/range_snapshot.cc',
+        'src/arrow_ipc.cc',
+        'src/csv.cc',
+        'src/object_shape.cc',
+        'src/utf8_string.cc',
+        'src/string_pool.cc',
+        'src/external_strings.cc',
+        'src/thread_pool.cc',
+        'src/batch_loader.cc'
       ],
       'include_dirs': [
         'deps/libxl/include_cpp',
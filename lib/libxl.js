@@ -24,4 +24,7 @@ if (!bindings) {
     throw new Error('unable to load libxl.node');
 }
 
+require('./rows')(bindings);
+require('./promises')(bindings);
+
 module.exports = bindings;
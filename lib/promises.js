@@ -0,0 +1,117 @@
+// Promise based variants of the async methods. Each takes the arguments of
+// the callback based method (without the callback), followed by an optional
+// options object. Its `signal` property may hold an AbortSignal: aborting
+// removes the operation from the queue of the book, or drops the result if
+// the operation is already running. The `priority` property overrides the
+// async priority of the book for this call.
+
+function abortError(signal) {
+    var error = new Error('The operation was aborted');
+
+    error.name = 'AbortError';
+    error.code = 'ABORT_ERR';
+    if (signal.reason !== undefined) error.cause = signal.reason;
+
+    return error;
+}
+
+function firstResult(results) {
+    return results[1];
+}
+
+function pictureResult(results) {
+    return {type: results[1], data: results[2]};
+}
+
+// Async calls take their priority from the book when they are made
+function applyWithPriority(target, method, args, priority) {
+    if (priority === undefined) return method.apply(target, args);
+
+    var previous = target.asyncPriority();
+
+    target.setAsyncPriority(priority);
+    try {
+        method.apply(target, args);
+    } finally {
+        target.setAsyncPriority(previous);
+    }
+}
+
+function callAsync(target, method, args, options, getResult) {
+    var signal = options && options.signal,
+        priority = options && options.priority;
+
+    return new Promise(function(resolve, reject) {
+        if (signal && signal.aborted) {
+            return reject(abortError(signal));
+        }
+
+        function onAbort() {
+            target.cancelAsync(callback);
+            reject(abortError(signal));
+        }
+
+        function callback(err) {
+            if (signal) signal.removeEventListener('abort', onAbort);
+
+            if (err) {
+                reject(err);
+            } else {
+                resolve(getResult(arguments));
+            }
+        }
+
+        args.push(callback);
+        applyWithPriority(target, method, args, priority);
+
+        if (signal) signal.addEventListener('abort', onAbort);
+    });
+}
+
+// argCount is the number of positional arguments of the wrapped method. If
+// the wrapped method takes an options object itself (withOptions), the
+// options are passed on.
+function definePromise(prototype, name, methodName, argCount, withOptions,
+    getResult)
+{
+    var method = prototype[methodName];
+
+    prototype[name] = function() {
+        var args = Array.prototype.slice.call(arguments, 0, argCount),
+            options = arguments[argCount];
+
+        while (args.length < argCount) args.push(undefined);
+        if (withOptions) args.push(options);
+
+        return callAsync(this, method, args, options, getResult || firstResult);
+    };
+}
+
+
+module.exports = function(bindings) {
+    if (typeof(Promise) !== 'function') return;
+
+    var book = bindings.Book.prototype,
+        sheet = bindings.Sheet.prototype;
+
+    definePromise(book, 'loadPromise', 'load', 1, false);
+    definePromise(book, 'writePromise', 'write', 1, false);
+    definePromise(book, 'loadRawPromise', 'loadRaw', 1, false);
+    definePromise(book, 'writeRawPromise', 'writeRaw', 0, false);
+    definePromise(book, 'getPicturePromise', 'getPictureAsync', 1, false,
+        pictureResult);
+    definePromise(book, 'addPicturePromise', 'addPictureAsync', 1, false);
+
+    book.savePromise = book.writePromise;
+    book.saveRawPromise = book.writeRawPromise;
+
+    definePromise(sheet, 'insertRowPromise', 'insertRowAsync', 2, false);
+    definePromise(sheet, 'insertColPromise', 'insertColAsync', 2, false);
+    definePromise(sheet, 'removeRowPromise', 'removeRowAsync', 2, false);
+    definePromise(sheet, 'removeColPromise', 'removeColAsync', 2, false);
+    definePromise(sheet, 'readRangePromise', 'readRangeAsync', 4, true);
+    definePromise(sheet, 'toArrowPromise', 'toArrow', 1, true);
+    definePromise(sheet, 'fromArrowPromise', 'fromArrow', 3, true);
+    definePromise(sheet, 'toCSVPromise', 'toCSV', 1, true);
+    definePromise(sheet, 'fromCSVPromise', 'fromCSV', 1, true);
+};
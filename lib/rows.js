@@ -0,0 +1,264 @@
+var DEFAULT_CHUNK_SIZE = 1024;
+
+// Sheet size limits of libxl and the largest range readRange accepts, see
+// util.h
+var MAX_ROWS = 1048576,
+    MAX_COLS = 16384,
+    MAX_RANGE_CELLS = 16777216;
+
+function isInt(value) {
+    return typeof(value) === 'number' && value % 1 === 0;
+}
+
+function getInt(options, name, def) {
+    var value = options[name];
+
+    if (value === undefined) return def;
+    if (!isInt(value)) {
+        throw new TypeError('integer required for option ' + name);
+    }
+
+    return value;
+}
+
+function isValidFirst(bound, max) {
+    return bound === null || (bound >= 0 && bound < max);
+}
+
+function isValidLast(bound, max) {
+    return bound === null || bound < max;
+}
+
+// Common range bookkeeping for the sync and async iterators. Rows are pulled
+// from the bindings in chunks of up to chunkSize rows via readRange.
+// Omitted bounds default to the used area of the sheet. They are resolved on
+// first use, as the book may still be busy when the iterator is created.
+function RowCursor(sheet, options) {
+    this.sheet = sheet;
+    this.chunkSize = getInt(options, 'chunkSize', DEFAULT_CHUNK_SIZE);
+    this.row = getInt(options, 'rowFirst', null);
+    this.rowLast = getInt(options, 'rowLast', null);
+    this.colFirst = getInt(options, 'colFirst', null);
+    this.colLast = getInt(options, 'colLast', null);
+
+    if (this.chunkSize <= 0) {
+        throw new RangeError('chunkSize must be positive');
+    }
+
+    if (!isValidFirst(this.row, MAX_ROWS) ||
+        !isValidFirst(this.colFirst, MAX_COLS) ||
+        !isValidLast(this.rowLast, MAX_ROWS) ||
+        !isValidLast(this.colLast, MAX_COLS))
+    {
+        throw new RangeError('invalid range');
+    }
+
+    // Only string handling options are passed on to readRange
+    this.rangeOptions = null;
+    if (options.pool !== undefined || options.externalStrings !== undefined) {
+        this.rangeOptions = {
+            pool: options.pool,
+            externalStrings: options.externalStrings
+        };
+    }
+
+    this.resolved = false;
+    this.finished = false;
+    this.chunk = null;
+    this.index = 0;
+}
+
+RowCursor.prototype.resolve = function() {
+    var sheet = this.sheet,
+        colCount;
+
+    if (this.row === null) this.row = sheet.firstRow();
+    if (this.rowLast === null) this.rowLast = sheet.lastRow() - 1;
+    if (this.colFirst === null) this.colFirst = sheet.firstCol();
+    if (this.colLast === null) this.colLast = sheet.lastCol() - 1;
+
+    // Keep every chunk within the cell limit of readRange
+    colCount = this.colLast - this.colFirst + 1;
+    if (colCount > 0) {
+        this.chunkSize = Math.min(this.chunkSize,
+            Math.floor(MAX_RANGE_CELLS / colCount));
+    }
+
+    this.resolved = true;
+};
+
+RowCursor.prototype.hasBufferedRows = function() {
+    return this.chunk !== null && this.index < this.chunk.length;
+};
+
+RowCursor.prototype.exhausted = function() {
+    if (this.finished) return true;
+    if (!this.resolved) this.resolve();
+
+    return this.row > this.rowLast || this.colFirst > this.colLast;
+};
+
+RowCursor.prototype.finish = function() {
+    this.finished = true;
+    this.chunk = null;
+};
+
+// Returns the readRange arguments for the next chunk and advances the cursor
+// past it
+RowCursor.prototype.claimChunk = function() {
+    var rowFirst = this.row,
+        rowLast = Math.min(rowFirst + this.chunkSize - 1, this.rowLast),
+        args = [rowFirst, rowLast, this.colFirst, this.colLast];
+
+    this.row = rowLast + 1;
+
+    if (this.rangeOptions) args.push(this.rangeOptions);
+
+    return args;
+};
+
+RowCursor.prototype.nextBufferedRow = function() {
+    return {done: false, value: this.chunk[this.index++]};
+};
+
+
+function RowIterator(sheet, options) {
+    this._cursor = new RowCursor(sheet, options || {});
+    this._options = options || {};
+}
+
+RowIterator.prototype.next = function() {
+    var cursor = this._cursor;
+
+    if (!cursor.hasBufferedRows()) {
+        if (cursor.exhausted()) {
+            return {done: true, value: undefined};
+        }
+
+        cursor.chunk = cursor.sheet.readRange.apply(cursor.sheet, cursor.claimChunk());
+        cursor.index = 0;
+    }
+
+    return cursor.nextBufferedRow();
+};
+
+RowIterator.prototype.return = function(value) {
+    this._cursor.finish();
+
+    return {done: true, value: value};
+};
+
+
+// While a chunk is being handed out, the next one is already read on the
+// thread pool. Note that the book is busy while a prefetch is pending.
+function AsyncRowIterator(sheet, options) {
+    this._cursor = new RowCursor(sheet, options);
+    this._pending = null;
+    this._queue = Promise.resolve();
+}
+
+AsyncRowIterator.prototype._fetch = function() {
+    var cursor = this._cursor;
+
+    if (cursor.exhausted()) return null;
+
+    var args = cursor.claimChunk(),
+        pending = new Promise(function(resolve, reject) {
+            args.push(function(err, rows) {
+                if (err) {
+                    reject(err);
+                } else {
+                    resolve(rows);
+                }
+            });
+
+            cursor.sheet.readRangeAsync.apply(cursor.sheet, args);
+        });
+
+    // Avoid unhandled rejections if iteration is abandoned during a prefetch
+    pending.catch(function() {});
+
+    return pending;
+};
+
+// Calls to next() and return() that are not awaited run one after the other,
+// so every chunk is handed out exactly once
+AsyncRowIterator.prototype._enqueue = function(step) {
+    var result = this._queue.then(step);
+
+    this._queue = result.catch(function() {});
+
+    return result;
+};
+
+AsyncRowIterator.prototype._next = function() {
+    var self = this,
+        cursor = this._cursor;
+
+    if (cursor.hasBufferedRows()) {
+        return cursor.nextBufferedRow();
+    }
+
+    var pending = this._pending || this._fetch();
+    this._pending = null;
+
+    if (!pending) {
+        return {done: true, value: undefined};
+    }
+
+    return pending.then(function(rows) {
+        cursor.chunk = rows;
+        cursor.index = 0;
+        self._pending = self._fetch();
+
+        return cursor.nextBufferedRow();
+    });
+};
+
+AsyncRowIterator.prototype.next = function() {
+    return this._enqueue(this._next.bind(this));
+};
+
+// Resolves once a pending prefetch has finished, so the book can be used
+// again right away
+AsyncRowIterator.prototype.return = function(value) {
+    var self = this;
+
+    return this._enqueue(function() {
+        var pending = self._pending;
+
+        self._cursor.finish();
+        self._pending = null;
+
+        function done() {
+            return {done: true, value: value};
+        }
+
+        return pending ? pending.then(done, done) : done();
+    });
+};
+
+
+module.exports = function(bindings) {
+    var hasSymbols = typeof(Symbol) === 'function';
+
+    if (hasSymbols && Symbol.iterator) {
+        RowIterator.prototype[Symbol.iterator] = function() {
+            return this;
+        };
+    }
+
+    if (hasSymbols && Symbol.asyncIterator && typeof(Promise) === 'function') {
+        RowIterator.prototype[Symbol.asyncIterator] = function() {
+            return new AsyncRowIterator(this._cursor.sheet, this._options);
+        };
+
+        AsyncRowIterator.prototype[Symbol.asyncIterator] = function() {
+            return this;
+        };
+    }
+
+    bindings.Sheet.prototype.rows = function(options) {
+        return new RowIterator(this, options);
+    };
+};
@@ -73,7 +73,8 @@ describe('The book class', function() {
     });
 
     it('book.load loads a book in async mode', function() {
-        var result = null;
+        var result = null,
+            stale = book.addSheet('stale');
 
         runs(function() {
             var file = testUtils.getWriteTestFile();
@@ -93,6 +94,7 @@ describe('The book class', function() {
 
         runs(function() {
             expect(result).toBeUndefined();
+            expect(book.getSheet(0)).not.toBe(stale);
             expect(book.getSheet(0).readStr(1, 0)).toBe('bar');
         });
     });
@@ -159,6 +161,256 @@ describe('The book class', function() {
         });
     });
 
+    it('async operations on a book are queued and run in order', function() {
+        var book1 = new xl.Book(xl.BOOK_TYPE_XLS),
+            book2 = new xl.Book(xl.BOOK_TYPE_XLS),
+            sheet = book1.addSheet('foo'),
+            calls = [],
+            buffer = null;
+
+        sheet.writeStr(1, 0, 'bar');
+
+        runs(function() {
+            expect(sheet.insertRowAsync(0, 1, function(err) {
+                expect(err).toBeUndefined();
+                calls.push('insertRow');
+
+                // The write is still queued
+                shouldThrow(sheet.readStr, sheet, 3, 0);
+            })).toBe(sheet);
+
+            book1.writeRaw(function(err, result) {
+                expect(err).toBeUndefined();
+                calls.push('writeRaw');
+
+                buffer = result;
+            });
+
+            shouldThrow(book1.sheetCount, book1);
+            shouldThrow(book1.writeRaw, book1, 1);
+        });
+
+        waitsFor(function() {
+            return !!buffer;
+        }, 'queued operations to finish', 1000);
+
+        runs(function() {
+            expect(calls).toEqual(['insertRow', 'writeRaw']);
+            expect(book2.loadRawSync(buffer).getSheet(0).readStr(3, 0)).toBe('bar');
+        });
+    });
+
+    it('promise variants of the async methods support cancellation', function() {
+        if (typeof(Promise) !== 'function') return;
+
+        var book1 = new xl.Book(xl.BOOK_TYPE_XLS),
+            book2 = new xl.Book(xl.BOOK_TYPE_XLS),
+            sheet = book1.addSheet('foo'),
+            signal = testUtils.newAbortSignal(),
+            calls = [],
+            done = false;
+
+        sheet.writeStr(1, 0, 'bar');
+
+        runs(function() {
+            shouldThrow(book1.cancelAsync, book1, 1);
+            shouldThrow(book1.cancelAsync, {}, function() {});
+            expect(book1.cancelAsync(function() {})).toBe(false);
+
+            var first = book1.writeRawPromise().then(function(buffer) {
+                calls.push('first');
+
+                return book2.loadRawPromise(buffer);
+            });
+
+            // Queued behind the first write and removed on abort
+            var aborted = book1.writeRawPromise({signal: signal}).then(function() {
+                calls.push('aborted');
+            }, function(err) {
+                expect(err.name).toBe('AbortError');
+                calls.push('rejected');
+            });
+
+            signal.abort();
+
+            book1.loadRawPromise(1).catch(function(err) {
+                expect(err instanceof Error).toBe(true);
+                calls.push('invalid');
+            });
+
+            Promise.all([first, aborted]).then(function() {
+                expect(calls).toEqual(['rejected', 'invalid', 'first']);
+                expect(book2.getSheet(0).readStr(1, 0)).toBe('bar');
+
+                return sheet.insertRowPromise(0, 0, {signal: signal});
+            }).catch(function(err) {
+                // Signals that are aborted already reject right away
+                expect(err.name).toBe('AbortError');
+                expect(sheet.readStr(1, 0)).toBe('bar');
+
+                done = true;
+            });
+        });
+
+        waitsFor(function() {
+            return done;
+        }, 'promises to settle', 1000);
+    });
+
+    it('xl.setThreadPoolSize resizes the pool for async operations', function() {
+        var size = xl.threadPoolSize(),
+            book1 = new xl.Book(xl.BOOK_TYPE_XLS),
+            book2 = new xl.Book(xl.BOOK_TYPE_XLSX),
+            results = [];
+
+        shouldThrow(xl.setThreadPoolSize, xl, 0);
+        shouldThrow(xl.setThreadPoolSize, xl, 'a');
+        shouldThrow(xl.setThreadPoolSize, xl, 1000);
+
+        xl.setThreadPoolSize(1);
+        expect(xl.threadPoolSize()).toBe(1);
+
+        book1.addSheet('foo');
+        book2.addSheet('bar');
+
+        runs(function() {
+            book1.writeRaw(function(err, buffer) {
+                expect(err).toBeUndefined();
+                results.push(buffer);
+
+                xl.setThreadPoolSize(size);
+            });
+
+            book2.writeRaw(function(err, buffer) {
+                expect(err).toBeUndefined();
+                results.push(buffer);
+            });
+        });
+
+        waitsFor(function() {
+            return results.length === 2;
+        }, 'books to save', 1000);
+
+        runs(function() {
+            expect(xl.threadPoolSize()).toBe(size);
+        });
+    });
+
+    it('book.setAsyncPriority sets the priority of async operations', function() {
+        var book = new xl.Book(xl.BOOK_TYPE_XLS),
+            sheet = book.addSheet('foo'),
+            buffer = null,
+            rejected = false;
+
+        expect(xl.PRIORITY_INTERACTIVE).toBeLessThan(xl.PRIORITY_NORMAL);
+        expect(xl.PRIORITY_NORMAL).toBeLessThan(xl.PRIORITY_BULK);
+
+        shouldThrow(book.setAsyncPriority, book, 'a');
+        shouldThrow(book.setAsyncPriority, book, -1);
+        shouldThrow(book.setAsyncPriority, book, xl.PRIORITY_BULK + 1);
+        shouldThrow(book.setAsyncPriority, {}, xl.PRIORITY_BULK);
+
+        expect(book.asyncPriority()).toBe(xl.PRIORITY_NORMAL);
+        expect(book.setAsyncPriority(xl.PRIORITY_BULK)).toBe(book);
+        expect(sheet.asyncPriority()).toBe(xl.PRIORITY_BULK);
+        expect(sheet.setAsyncPriority(xl.PRIORITY_INTERACTIVE)).toBe(sheet);
+        expect(book.asyncPriority()).toBe(xl.PRIORITY_INTERACTIVE);
+
+        runs(function() {
+            book.writeRaw(function(err, result) {
+                expect(err).toBeUndefined();
+                buffer = result;
+            });
+
+            // Can be changed while operations are pending
+            book.setAsyncPriority(xl.PRIORITY_NORMAL);
+        });
+
+        waitsFor(function() {
+            return !!buffer;
+        }, 'book to save', 1000);
+
+        runs(function() {
+            if (typeof(Promise) !== 'function') {
+                rejected = true;
+                return;
+            }
+
+            book.writeRawPromise({priority: 5}).catch(function(err) {
+                expect(err instanceof RangeError).toBe(true);
+                rejected = true;
+            });
+        });
+
+        waitsFor(function() {
+            return rejected;
+        }, 'invalid priority to be rejected', 1000);
+
+        runs(function() {
+            expect(book.asyncPriority()).toBe(xl.PRIORITY_NORMAL);
+        });
+    });
+
+    it('xl.Book.loadMany loads a list of books in parallel', function() {
+        var dir = require('path').dirname(testUtils.getWriteTestFile()),
+            xlsFile = dir + '/loadmany.xls',
+            xlsxFile = dir + '/loadmany.xlsx',
+            csvFile = testUtils.getWriteTestCsvFile(),
+            files = [xlsFile, xlsxFile, csvFile, dir + '/missing.xls'],
+            results = [],
+            done = false,
+            emptyDone = false;
+
+        [[xl.BOOK_TYPE_XLS, xlsFile], [xl.BOOK_TYPE_XLSX, xlsxFile]].forEach(
+            function(spec) {
+                var book = new xl.Book(spec[0]);
+
+                book.addSheet('foo').writeStr(1, 0, spec[1]);
+                book.writeSync(spec[1]);
+            });
+        fs.writeFileSync(csvFile, 'a,b\n');
+
+        function noop() {}
+
+        shouldThrow(xl.Book.loadMany, xl.Book, 'a', noop, noop);
+        shouldThrow(xl.Book.loadMany, xl.Book, [1], noop, noop);
+        shouldThrow(xl.Book.loadMany, xl.Book, files, {concurrency: 0}, noop, noop);
+        shouldThrow(xl.Book.loadMany, xl.Book, files, {priority: -1}, noop, noop);
+        shouldThrow(xl.Book.loadMany, xl.Book, files, noop);
+
+        runs(function() {
+            xl.Book.loadMany(files, {concurrency: 1}, function(err, book, index) {
+                results[index] = {err: err, book: book};
+            }, function() {
+                done = true;
+            });
+
+            xl.Book.loadMany([], function() {
+                throw new Error('no books to report');
+            }, function() {
+                emptyDone = true;
+            });
+        });
+
+        waitsFor(function() {
+            return done && emptyDone;
+        }, 'books to load', 2000);
+
+        runs(function() {
+            expect(results.length).toBe(4);
+
+            [xlsFile, xlsxFile].forEach(function(file, i) {
+                expect(results[i].err).toBeUndefined();
+                expect(results[i].book instanceof xl.Book).toBe(true);
+                expect(results[i].book.getSheet(0).readStr(1, 0)).toBe(file);
+            });
+
+            [2, 3].forEach(function(i) {
+                expect(results[i].err instanceof Error).toBe(true);
+                expect(results[i].book).toBeUndefined();
+            });
+        });
+    });
 
     it('book.addSheet adds a sheet to a book', function() {
         shouldThrow(book.addSheet, book, 10);
@@ -196,6 +448,8 @@ describe('The book class', function() {
 
         var sheet2 = book.getSheet(0);
         expect(sheet2.readStr(1, 0)).toBe('bar');
+        expect(sheet2).toBe(sheet);
+        expect(book.getSheet(0)).toBe(sheet2);
     });
 
     it('book.sheetType determines sheet type', function() {
@@ -208,12 +462,13 @@ describe('The book class', function() {
 
     it('book.delSheet removes a sheet', function() {
         book.addSheet('foo');
-        book.addSheet('bar');
+        var bar = book.addSheet('bar');
         shouldThrow(book.delSheet, book, 'a');
         shouldThrow(book.delSheet, book, 3);
         shouldThrow(book.delSheet, {}, 0);
         expect(book.delSheet(0)).toBe(book);
         expect(book.sheetCount()).toBe(1);
+        expect(book.getSheet(0)).toBe(bar);
     });
 
     it('book.sheetCount counts the number of sheets in a book', function() {
@@ -260,6 +515,7 @@ describe('The book class', function() {
         shouldThrow(book.format, book, 'a');
         shouldThrow(book.format, {}, 0);
         expect(book.format(0) instanceof format.constructor).toBe(true);
+        expect(book.format(0)).toBe(book.format(0));
     });
 
     it('book.formatSize counts the number of formats', function() {
@@ -274,6 +530,7 @@ describe('The book class', function() {
         shouldThrow(book.font, book, -1);
         shouldThrow(book.font, {}, 0);
         expect(book.font(0) instanceof font.constructor).toBe(true);
+        expect(book.font(0)).toBe(book.font(0));
     });
 
     it('book.fontSize counts the number of fonts', function() {
@@ -11,6 +11,7 @@ describe('The format class', function() {
     it('format.font returns the font', function() {
         shouldThrow(format.font, {});
         expect(format.font() instanceof font.constructor).toBe(true);
+        expect(format.font()).toBe(format.font());
     });
 
     it('format.setFont sets the font', function() {
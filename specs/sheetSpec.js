@@ -1,5 +1,6 @@
 var xl = require('../lib/libxl'),
     util = require('util'),
+    fs = require('fs'),
     testUtils = require('./testUtils'),
     shouldThrow = testUtils.shouldThrow;
 
@@ -54,6 +55,7 @@ describe('The sheet class', function() {
 
         var cellFormat = sheet.cellFormat(row, 0);
         expect(format instanceof format.constructor).toBe(true);
+        expect(sheet.cellFormat(row, 0)).toBe(cellFormat);
     });
 
     it('sheet.setCellFormat sets the cell format', function() {
@@ -110,6 +112,12 @@ describe('The sheet class', function() {
         expect(function() {sheet.writeNum.call({}, row, 0, 10);}).toThrow();
 
         expect(function() {sheet.writeNum(row, 0, 10, wrongFormat);}).toThrow();
+        expect(function() {
+            sheet.writeNum.call(Object.create(xl.Sheet.prototype), row, 0, 10);
+        }).toThrow();
+        expect(function() {
+            sheet.writeNum(row, 0, 10, Object.create(format.constructor.prototype));
+        }).toThrow();
         expect(sheet.writeNum(row, 0, 10)).toBe(sheet);
         expect(sheet.writeNum(row, 0, 10, format)).toBe(sheet);
 
@@ -506,6 +514,11 @@ describe('The sheet class', function() {
             shouldThrow(sheet.insertRowAsync, {}, 2, 3, function() {});
             expect(sheet.insertRowAsync(2, 3, step1)).toBe(sheet);
             shouldThrow(sheet.name, sheet);
+            shouldThrow(sheet.readNum, sheet, 0, 0);
+            shouldThrow(sheet.writeNum, sheet, 0, 0, 1);
+            shouldThrow(sheet.writeBool, sheet, 0, 0, true);
+            shouldThrow(sheet.cellType, sheet, 0, 0);
+            shouldThrow(sheet.isFormula, sheet, 0, 0);
 
             function step1(err) {
                 expect(err).toBeUndefined();
@@ -862,6 +875,14 @@ describe('The sheet class', function() {
         expect(result.col).toBe(0);
         expect(result.rowRelative).toBe(true);
         expect(result.colRelative).toBe(true);
+
+        var result2 = sheet.addrToRowCol('$C$5');
+        expect(result2).not.toBe(result);
+        expect(Object.keys(result2)).toEqual(['row', 'col', 'rowRelative', 'colRelative']);
+        expect(result2.row).toBe(4);
+        expect(result2.col).toBe(2);
+        expect(result2.rowRelative).toBe(false);
+        expect(result.row).toBe(0);
     });
 
     it('sheet.rowColToAddr builds an address string', function() {
@@ -870,4 +891,605 @@ describe('The sheet class', function() {
         expect(sheet.rowColToAddr(0, 0)).toBe('A1');
         expect(sheet.rowColToAddr(0, 0, false, false)).toBe('$A$1');
     });
+
+    it('sheet.readCell and sheet.readCellInto read a cell in a single call', function() {
+        var sheet = newSheet(),
+            dateFormat = book.addFormat(),
+            target = {};
+
+        dateFormat.setNumFormat(xl.NUMFORMAT_DATE);
+        sheet
+            .writeNum(0, 0, 10, format)
+            .writeStr(0, 1, 'foo')
+            .writeBool(0, 2, true)
+            .writeNum(0, 3, book.datePack(2024, 1, 2), dateFormat);
+
+        shouldThrow(sheet.readCell, sheet, 'a', 0);
+        shouldThrow(sheet.readCell, sheet, 0, 0, {withFormat: 1});
+        shouldThrow(sheet.readCell, {}, 0, 0);
+        shouldThrow(sheet.readCellInto, sheet, 0, 0, 1);
+        shouldThrow(sheet.readCellInto, {}, 0, 0, target);
+
+        expect(sheet.readCell(0, 0)).toEqual(
+            {type: xl.CELLTYPE_NUMBER, value: 10, format: null, isDate: false});
+        expect(sheet.readCell(0, 0, {withFormat: true}).format).toBe(format);
+        expect(sheet.readCell(0, 1).value).toBe('foo');
+        expect(sheet.readCell(0, 2).value).toBe(true);
+        expect(sheet.readCell(0, 3).isDate).toBe(false);
+        expect(sheet.readCell(0, 3, {withDate: true}).isDate).toBe(true);
+        expect(sheet.readCell(5, 5)).toEqual(
+            {type: xl.CELLTYPE_EMPTY, value: null, format: null, isDate: false});
+
+        expect(sheet.readCellInto(0, 1, target, {withFormat: true})).toBe(target);
+        expect(target.type).toBe(xl.CELLTYPE_STRING);
+        expect(target.value).toBe('foo');
+        expect(sheet.readCellInto(0, 3, target, {withDate: true})).toBe(target);
+        expect(target.value).toBe(book.datePack(2024, 1, 2));
+        expect(target.isDate).toBe(true);
+    });
+
+    it('sheet.readRange reads a block of cells in a single call', function() {
+        var sheet = newSheet();
+
+        sheet
+            .writeStr(0, 0, 'foo')
+            .writeNum(0, 1, 10)
+            .writeBool(0, 2, true)
+            .writeStr(1, 0, 'bar')
+            .writeNum(1, 1, 20)
+            .writeFormula(2, 0, '=SUM(B1:B2)');
+
+        shouldThrow(sheet.readRange, sheet, 0, 1, 'a', 2);
+        shouldThrow(sheet.readRange, sheet, 0, 1, 0, 2, 1);
+        shouldThrow(sheet.readRange, sheet, 0, 1, 0, 2, {columns: 1});
+        shouldThrow(sheet.readRange, sheet, -1, 1, 0, 2);
+        shouldThrow(sheet.readRange, sheet, 0, 0x7fffffff, 0, 2);
+        shouldThrow(sheet.readRange, sheet, 0, 1e6, 0, 16383);
+        shouldThrow(sheet.readRange, {}, 0, 1, 0, 2);
+
+        expect(sheet.readRange(0, 1, 0, 2)).toEqual([
+            ['foo', 10, true],
+            ['bar', 20, null]
+        ]);
+        expect(sheet.readRange(1, 0, 0, 2)).toEqual([]);
+
+        var columns = sheet.readRange(0, 1, 0, 2, {columns: true});
+        expect(columns[0]).toEqual(['foo', 'bar']);
+        expect(columns[1] instanceof Float64Array).toBe(true);
+        expect(Array.prototype.slice.call(columns[1])).toEqual([10, 20]);
+        expect(columns[2]).toEqual([true, null]);
+
+        expect(sheet.readRange(2, 2, 0, 0, {formulas: true})).toEqual([['SUM(B1:B2)']]);
+    });
+
+    it('sheet.writeRows writes a block of cells in a single call', function() {
+        var sheet = newSheet();
+
+        shouldThrow(sheet.writeRows, sheet, 0, 0, 'a');
+        shouldThrow(sheet.writeRows, sheet, 0, 0, ['a']);
+        shouldThrow(sheet.writeRows, sheet, 0, 0, [[{}]]);
+        shouldThrow(sheet.writeRows, sheet, 0, 0, [[1]], [wrongFormat]);
+        shouldThrow(sheet.writeRows, sheet, 0, 0, [[1]], [1]);
+        shouldThrow(sheet.writeRows, {}, 0, 0, [[1]]);
+
+        // Invalid batches are rejected before anything is written
+        shouldThrow(sheet.writeRows, sheet, 5, 0, [['x', 1], ['y', {}]]);
+        expect(sheet.cellType(5, 0)).toBe(xl.CELLTYPE_EMPTY);
+        shouldThrow(sheet.writeRows, sheet, 5, 0, [['x'], 'y']);
+        expect(sheet.cellType(5, 0)).toBe(xl.CELLTYPE_EMPTY);
+
+        expect(sheet.writeRows(1, 1, [
+            ['foo', 10, true],
+            ['bar', null, false]
+        ], [null, format, format])).toBe(sheet);
+
+        expect(sheet.readRange(1, 2, 1, 3)).toEqual([
+            ['foo', 10, true],
+            ['bar', null, false]
+        ]);
+        expect(sheet.cellType(2, 2)).toBe(xl.CELLTYPE_BLANK);
+    });
+
+    it('sheet.writeNumColumn and sheet.readNumColumn transfer numeric columns as Float64Array', function() {
+        var sheet = newSheet(),
+            values = new Float64Array([1, 2.5, NaN, 4]);
+
+        sheet.writeStr(3, 1, 'foo');
+
+        shouldThrow(sheet.writeNumColumn, sheet, 0, 0, [1, 2]);
+        shouldThrow(sheet.writeNumColumn, sheet, 0, 0, values, wrongFormat);
+        shouldThrow(sheet.writeNumColumn, {}, 0, 0, values);
+        shouldThrow(sheet.writeNumColumn, sheet, -1, 0, values);
+        shouldThrow(sheet.writeNumColumn, sheet, 1048575, 0, values);
+        shouldThrow(sheet.writeNumColumn, sheet, 0x7fffffff, 0, values);
+        shouldThrow(sheet.writeNumColumn, sheet, 0, 16384, values);
+        expect(sheet.writeNumColumn(0, 1, values, format)).toBe(sheet);
+
+        shouldThrow(sheet.readNumColumn, sheet, 0, 3, 'a');
+        shouldThrow(sheet.readNumColumn, sheet, 0, 3, 1, [1]);
+        shouldThrow(sheet.readNumColumn, sheet, 0, 3, 1, new Float64Array(2));
+        shouldThrow(sheet.readNumColumn, {}, 0, 3, 1);
+        shouldThrow(sheet.readNumColumn, sheet, -1, 3, 1);
+        shouldThrow(sheet.readNumColumn, sheet, 0, 0x7fffffff, 1);
+        shouldThrow(sheet.readNumColumn, sheet, 0, 1048576, 1);
+        shouldThrow(sheet.readNumColumn, sheet, 0, 3, 16384);
+
+        var result = sheet.readNumColumn(0, 4, 1);
+        expect(result instanceof Float64Array).toBe(true);
+        expect(result.length).toBe(5);
+        expect(result[0]).toBe(1);
+        expect(result[1]).toBe(2.5);
+        expect(isNaN(result[2])).toBe(true);
+        expect(result[3]).toBe(4);
+        expect(isNaN(result[4])).toBe(true);
+
+        var target = new Float64Array(4);
+        expect(sheet.readNumColumn(0, 1, 1, target)).toBe(target);
+        expect(target[1]).toBe(2.5);
+    });
+
+    it('sheet.readRangeAsync reads a block of cells in async mode', function() {
+        var sheet = newSheet(),
+            done = false;
+
+        sheet
+            .writeStr(0, 0, 'foo')
+            .writeNum(0, 1, 10)
+            .writeStr(1, 0, 'bar')
+            .writeNum(1, 1, 20);
+
+        runs(function() {
+            shouldThrow(sheet.readRangeAsync, sheet, 0, 1, 0, 1);
+            shouldThrow(sheet.readRangeAsync, sheet, 0, 1, 0, 'a', function() {});
+            shouldThrow(sheet.readRangeAsync, sheet, 0, 1e6, 0, 16383, function() {});
+            shouldThrow(sheet.readRangeAsync, {}, 0, 1, 0, 1, function() {});
+
+            expect(sheet.readRangeAsync(0, 1, 0, 1, step1)).toBe(sheet);
+            shouldThrow(sheet.readStr, sheet, 0, 0);
+
+            function step1(err, rows) {
+                expect(err).toBeUndefined();
+                expect(rows).toEqual([['foo', 10], ['bar', 20]]);
+
+                sheet.readRangeAsync(0, 1, 0, 1, {columns: true}, step2);
+            }
+
+            function step2(err, columns) {
+                expect(err).toBeUndefined();
+                expect(columns[0]).toEqual(['foo', 'bar']);
+                expect(columns[1] instanceof Float64Array).toBe(true);
+
+                done = true;
+            }
+        });
+
+        waitsFor(function() {
+            return done;
+        }, 3000, 'readRangeAsync to finish');
+    });
+
+    it('xl.StringPool deduplicates strings read from a sheet', function() {
+        var sheet = newSheet(),
+            pool = new xl.StringPool(),
+            done = false;
+
+        sheet
+            .writeStr(0, 0, 'red')
+            .writeStr(0, 1, 'green')
+            .writeStr(1, 0, 'red')
+            .writeNum(1, 1, 1);
+
+        expect(xl.StringPool() instanceof xl.StringPool).toBe(true);
+
+        shouldThrow(sheet.readRange, sheet, 0, 1, 0, 1, {pool: {}});
+        shouldThrow(sheet.readStr, sheet, 0, 0, null, {});
+        shouldThrow(sheet.readCell, sheet, 0, 0, {pool: 1});
+
+        expect(pool.size()).toBe(0);
+        expect(sheet.readRange(0, 1, 0, 1, {pool: pool}))
+            .toEqual([['red', 'green'], ['red', 1]]);
+        expect(pool.size()).toBe(2);
+
+        expect(sheet.readStr(1, 0, null, pool)).toBe('red');
+        expect(sheet.readCell(0, 1, {pool: pool}).value).toBe('green');
+        expect(pool.size()).toBe(2);
+
+        sheet.writeStr(2, 0, 'blue');
+        expect(sheet.rows({rowFirst: 2, rowLast: 2, colFirst: 0, colLast: 0, pool: pool})
+            .next().value).toEqual(['blue']);
+        expect(pool.size()).toBe(3);
+
+        expect(pool.clear()).toBe(pool);
+        expect(pool.size()).toBe(0);
+
+        runs(function() {
+            sheet.readRangeAsync(0, 1, 0, 1, {pool: pool}, function(err, rows) {
+                expect(err).toBeUndefined();
+                expect(rows).toEqual([['red', 'green'], ['red', 1]]);
+                expect(pool.size()).toBe(2);
+
+                done = true;
+            });
+        });
+
+        waitsFor(function() {
+            return done;
+        }, 3000, 'readRangeAsync to finish');
+    });
+
+    it('sheet.readRange exposes large strings as external strings on request', function() {
+        var sheet = newSheet(),
+            large = new Array(300).join('Zürich ') + 'end',
+            done = false;
+
+        sheet
+            .writeStr(0, 0, large)
+            .writeStr(0, 1, 'small')
+            .writeStr(1, 0, large + ' €')
+            .writeNum(1, 1, 1);
+
+        shouldThrow(sheet.readRange, sheet, 0, 1, 0, 1, {externalStrings: 1});
+
+        expect(sheet.readRange(0, 1, 0, 1, {externalStrings: true}))
+            .toEqual([[large, 'small'], [large + ' €', 1]]);
+        expect(sheet.readRange(0, 1, 0, 0, {externalStrings: true, columns: true}))
+            .toEqual([[large, large + ' €']]);
+
+        runs(function() {
+            sheet.readRangeAsync(0, 0, 0, 0, {externalStrings: true}, function(err, rows) {
+                expect(err).toBeUndefined();
+                expect(rows[0][0]).toBe(large);
+                expect(rows[0][0].slice(-3)).toBe('end');
+
+                done = true;
+            });
+        });
+
+        waitsFor(function() {
+            return done;
+        }, 3000, 'readRangeAsync to finish');
+    });
+
+    it('sheet.rows iterates over the rows of a sheet in chunks', function() {
+        var sheet = newSheet(),
+            iterator, result, rows = [];
+
+        sheet.writeRows(0, 0, [['a', 1], ['b', 2], ['c', 3]]);
+
+        expect(function() {sheet.rows({chunkSize: 'a'});}).toThrow();
+        expect(function() {sheet.rows({chunkSize: 0});}).toThrow();
+        expect(function() {sheet.rows({rowLast: 0x7fffffff});}).toThrow();
+        expect(function() {sheet.rows({rowFirst: 1048576});}).toThrow();
+        expect(function() {sheet.rows({colFirst: 16384});}).toThrow();
+
+        iterator = sheet.rows({chunkSize: 2});
+        while (!(result = iterator.next()).done) {
+            rows.push(result.value);
+        }
+        expect(rows).toEqual([['a', 1], ['b', 2], ['c', 3]]);
+
+        rows = [];
+        iterator = sheet.rows({rowFirst: 1, rowLast: 1});
+        while (!(result = iterator.next()).done) {
+            rows.push(result.value);
+        }
+        expect(rows).toEqual([['b', 2]]);
+
+        if (typeof(Symbol) === 'function' && Symbol.iterator) {
+            expect(iterator[Symbol.iterator]()).toBe(iterator);
+        }
+    });
+
+    it('sheet.rows supports async iteration with prefetching', function() {
+        if (typeof(Symbol) !== 'function' || !Symbol.asyncIterator) return;
+
+        var sheet = newSheet(),
+            rows = [],
+            done = false;
+
+        sheet.writeRows(0, 0, [['a', 1], ['b', 2], ['c', 3]]);
+
+        runs(function() {
+            var iterator;
+
+            // The bounds are resolved on the first call to next(), so the
+            // iterator can be created while the book is busy
+            sheet.readRangeAsync(0, 0, 0, 0, function() {
+                iterator.next().then(step);
+            });
+            iterator = sheet.rows({chunkSize: 2})[Symbol.asyncIterator]();
+
+            function step(result) {
+                if (result.done) {
+                    done = true;
+                    return;
+                }
+
+                rows.push(result.value);
+                return iterator.next().then(step);
+            }
+        });
+
+        waitsFor(function() {
+            return done;
+        }, 3000, 'async iteration to finish');
+
+        runs(function() {
+            expect(rows).toEqual([['a', 1], ['b', 2], ['c', 3]]);
+
+            var iterator = sheet.rows({chunkSize: 2})[Symbol.asyncIterator](),
+                first = iterator.next(),
+                second = iterator.next();
+
+            done = false;
+            Promise.all([first, second]).then(function(results) {
+                expect(results.map(function(result) {
+                    return result.value;
+                })).toEqual([['a', 1], ['b', 2]]);
+
+                // The prefetch of the next chunk is pending at this point
+                return iterator.return();
+            }).then(function(result) {
+                expect(result.done).toBe(true);
+                expect(sheet.readStr(0, 0)).toBe('a');
+
+                done = true;
+            });
+        });
+
+        waitsFor(function() {
+            return done;
+        }, 3000, 'async iteration to be stopped');
+    });
+
+    it('sheet.cellTypes scans the cell types of a range into a Uint8Array', function() {
+        var sheet = newSheet();
+
+        sheet
+            .writeStr(0, 0, 'foo')
+            .writeNum(0, 1, book.datePack(2000, 1, 1),
+                book.addFormat().setNumFormat(xl.NUMFORMAT_DATE))
+            .writeFormula(1, 0, '=1+1');
+
+        shouldThrow(sheet.cellTypes, sheet, 0, 1, 0, 'a');
+        shouldThrow(sheet.cellTypes, sheet, -1, 1, 0, 1);
+        shouldThrow(sheet.cellTypes, sheet, 0, 65535, 0, 65536);
+        shouldThrow(sheet.cellTypes, sheet, 0, 0x7fffffff, 0, 1);
+        shouldThrow(sheet.cellTypes, sheet, 0, 1048575, 0, 16383);
+        shouldThrow(sheet.cellTypes, {}, 0, 1, 0, 1);
+
+        var types = sheet.cellTypes(0, 1, 0, 1);
+        expect(types instanceof Uint8Array).toBe(true);
+        expect(types.length).toBe(4);
+
+        expect(types[0]).toBe(xl.CELLTYPE_STRING);
+        expect(types[1] & xl.CELLTYPE_MASK).toBe(xl.CELLTYPE_NUMBER);
+        expect(types[1] & xl.CELLFLAG_DATE).toBe(xl.CELLFLAG_DATE);
+        expect(types[2] & xl.CELLFLAG_FORMULA).toBe(xl.CELLFLAG_FORMULA);
+        expect(types[2] & xl.CELLFLAG_DATE).toBe(0);
+        expect(types[3]).toBe(xl.CELLTYPE_EMPTY);
+    });
+
+    it('sheet.readRangeBinary and sheet.writeRangeBinary transfer ranges in binary encoding', function() {
+        var sheet = newSheet(),
+            target = newSheet();
+
+        sheet.writeRows(0, 0, [
+            ['foo', 1.5, true],
+            ['bar', null, 'foo']
+        ]);
+
+        shouldThrow(sheet.readRangeBinary, sheet, 0, 1, 0, 'a');
+        shouldThrow(sheet.readRangeBinary, sheet, 0, 0x7fffffff, 0, 1);
+        shouldThrow(sheet.readRangeBinary, {}, 0, 1, 0, 2);
+
+        var buffer = sheet.readRangeBinary(0, 1, 0, 2);
+        expect(Buffer.isBuffer(buffer)).toBe(true);
+        expect(buffer.toString('ascii', 0, 4)).toBe('XLRB');
+        expect(buffer.readUInt32LE(8)).toBe(2);
+        expect(buffer.readUInt32LE(12)).toBe(3);
+        expect(buffer.readUInt32LE(24)).toBe(2);
+
+        shouldThrow(target.writeRangeBinary, target, 0, 0, 'a');
+        shouldThrow(target.writeRangeBinary, target, 0, 0, buffer.slice(0, 20));
+
+        // Headers with bogus dimensions
+        [[0x7fffffff, 0], [0x80000000, 0], [1048577, 1], [1, 16385]].forEach(function(size) {
+            var crafted = new Buffer(36);
+
+            crafted.fill(0);
+            buffer.copy(crafted, 0, 0, 8);
+            crafted.writeUInt32LE(size[0], 8);
+            crafted.writeUInt32LE(size[1], 12);
+
+            shouldThrow(target.writeRangeBinary, target, 0, 0, crafted);
+        });
+        expect(sheet.readRangeBinary(0, 1, 1, 0).readUInt32LE(8)).toBe(0);
+
+        // Unknown cell type tag in place of the empty cell at (1, 1)
+        var badTag = new Buffer(buffer.length);
+        buffer.copy(badTag);
+        expect(badTag[32 + 4]).toBe(xl.CELLTYPE_EMPTY);
+        badTag[32 + 4] = 0x7f;
+        shouldThrow(target.writeRangeBinary, target, 0, 0, badTag);
+        shouldThrow(target.writeRangeBinary, {}, 0, 0, buffer);
+
+        expect(target.writeRangeBinary(1, 1, buffer)).toBe(target);
+        expect(target.readRange(1, 2, 1, 3)).toEqual([
+            ['foo', 1.5, true],
+            ['bar', null, 'foo']
+        ]);
+    });
+
+    it('sheet.toArrow and sheet.fromArrow transfer ranges as Arrow IPC streams', function() {
+        var sheet = newSheet(),
+            target = newSheet(),
+            dateFormat = book.addFormat(),
+            date = book.datePack(2024, 1, 2),
+            done = false;
+
+        dateFormat.setNumFormat(xl.NUMFORMAT_DATE);
+
+        sheet
+            .writeRows(0, 0, [
+                ['num', 'str', 'bool', 'mixed'],
+                [1.5, 'foo', true, 1],
+                [null, 'bar', false, 'x']
+            ])
+            .writeStr(0, 4, 'date')
+            .writeNum(1, 4, date, dateFormat);
+
+        runs(function() {
+            shouldThrow(sheet.toArrow, sheet, {rowFirst: 'a'}, function() {});
+            shouldThrow(sheet.toArrow, sheet, {rowFirst: -1}, function() {});
+            shouldThrow(sheet.toArrow, sheet, {rowLast: 0x7fffffff}, function() {});
+            shouldThrow(sheet.toArrow, {}, {}, function() {});
+            shouldThrow(target.fromArrow, target, 'a', 0, 0, function() {});
+
+            expect(sheet.toArrow({rowLast: 2, colLast: 4}, {headerRow: true},
+                step1)).toBe(sheet);
+            shouldThrow(sheet.readStr, sheet, 0, 0);
+
+            function step1(err, buffer) {
+                expect(err).toBeUndefined();
+                expect(Buffer.isBuffer(buffer)).toBe(true);
+                expect(buffer.readUInt32LE(0)).toBe(0xFFFFFFFF);
+
+                target.fromArrow(buffer, 1, 1, {headerRow: true}, step2);
+            }
+
+            function step2(err) {
+                expect(err).toBeUndefined();
+
+                expect(target.readRange(1, 3, 1, 5)).toEqual([
+                    ['num', 'str', 'bool', 'mixed', 'date'],
+                    [1.5, 'foo', true, '1', date],
+                    [null, 'bar', false, 'x', null]
+                ]);
+                expect(target.isDate(2, 5)).toBe(true);
+
+                target.fromArrow(new Buffer('foo'), 0, 0, step3);
+            }
+
+            function step3(err) {
+                expect(err instanceof Error).toBe(true);
+
+                done = true;
+            }
+        });
+
+        waitsFor(function() {
+            return done;
+        }, 3000, 'toArrow and fromArrow to finish');
+    });
+
+    it('sheet.toCSV exports a range as CSV in async mode', function() {
+        var sheet = newSheet(),
+            dateFormat = book.addFormat(),
+            file = testUtils.getWriteTestCsvFile(),
+            done = false;
+
+        testUtils.initFilesystem();
+        dateFormat.setNumFormat(xl.NUMFORMAT_DATE);
+
+        sheet
+            .writeRows(0, 0, [
+                ['a,b', 'say "hi"', 1 / 3],
+                [true, null, 1e21]
+            ])
+            .writeNum(1, 3, book.datePack(2024, 1, 2), dateFormat);
+
+        runs(function() {
+            shouldThrow(sheet.toCSV, sheet, 1, function() {});
+            shouldThrow(sheet.toCSV, sheet, null, {delimiter: ';;'}, function() {});
+            shouldThrow(sheet.toCSV, sheet, null, {range: {rowFirst: 'a'}}, function() {});
+            shouldThrow(sheet.toCSV, sheet, null, {range: {colLast: 0x7fffffff}}, function() {});
+            shouldThrow(sheet.toCSV, {}, function() {});
+
+            expect(sheet.toCSV(step1)).toBe(sheet);
+            shouldThrow(sheet.readStr, sheet, 0, 0);
+
+            function step1(err, buffer) {
+                expect(err).toBeUndefined();
+                expect(buffer.toString()).toBe(
+                    '"a,b","say ""hi""",0.3333333333333333,\ntrue,,1e+21,2024-01-02\n');
+
+                sheet.toCSV(file, {
+                    delimiter: ';',
+                    quote: "'",
+                    range: {rowFirst: 1, colLast: 2}
+                }, step2);
+            }
+
+            function step2(err, buffer) {
+                expect(err).toBeUndefined();
+                expect(buffer).toBeUndefined();
+                expect(fs.readFileSync(file).toString()).toBe('true;;1e+21\n');
+
+                done = true;
+            }
+        });
+
+        waitsFor(function() {
+            return done;
+        }, 3000, 'toCSV to finish');
+    });
+
+    it('sheet.fromCSV imports CSV in async mode', function() {
+        var sheet = newSheet(),
+            file = testUtils.getWriteTestCsvFile(),
+            format = book.addFormat(),
+            done = false;
+
+        testUtils.initFilesystem();
+        fs.writeFileSync(file, 'a;b\r\n1;2\r\n');
+
+        runs(function() {
+            shouldThrow(sheet.fromCSV, sheet, 1, function() {});
+            shouldThrow(sheet.fromCSV, sheet, new Buffer(''), {delimiter: '"'}, function() {});
+            shouldThrow(sheet.fromCSV, sheet, new Buffer(''), {row: -1}, function() {});
+            shouldThrow(sheet.fromCSV, sheet, new Buffer(''), {formats: [1]}, function() {});
+            shouldThrow(sheet.fromCSV, {}, new Buffer(''), function() {});
+
+            expect(sheet.fromCSV(new Buffer(
+                'x,1,TRUE,2024-01-02,"q,""r"""\n' +
+                ',2.5e3,false,2024-01-02 12:30,inf\n' +
+                '"",007,"12",2023-02-31,2024-02-29\n'
+            ), {row: 1, col: 1, formats: [format]}, step1)).toBe(sheet);
+            shouldThrow(sheet.readStr, sheet, 1, 1);
+
+            function step1(err) {
+                expect(err).toBeUndefined();
+
+                expect(sheet.readRange(1, 3, 1, 5)).toEqual([
+                    ['x', 1, true, sheet.readNum(1, 4), 'q,"r'],
+                    [null, 2500, false, sheet.readNum(2, 4), 'inf'],
+                    ['', '007', '12', '2023-02-31', sheet.readNum(3, 5)]
+                ]);
+                expect(sheet.readNum(2, 4) - sheet.readNum(1, 4)).toBeCloseTo(12.5 / 24, 10);
+                expect(sheet.isDate(1, 4)).toBe(true);
+                expect(sheet.isDate(2, 4)).toBe(true);
+                expect(sheet.isDate(3, 5)).toBe(true);
+
+                sheet.fromCSV(file, {delimiter: ';', inferTypes: false}, step2);
+            }
+
+            function step2(err) {
+                expect(err).toBeUndefined();
+                expect(sheet.readRange(0, 1, 0, 1)).toEqual([['a', 'b'], ['1', '2']]);
+
+                sheet.fromCSV(file + '.missing', step3);
+            }
+
+            function step3(err) {
+                expect(err instanceof Error).toBe(true);
+
+                done = true;
+            }
+        });
+
+        waitsFor(function() {
+            return done;
+        }, 3000, 'fromCSV to finish');
+    });
 });
@@ -3,6 +3,7 @@ var path = require('path'),
 
 var outputDir = path.join(__dirname, 'output'),
     writeTestFile = path.join(outputDir, 'writetest.xls'),
+    writeTestCsvFile = path.join(outputDir, 'writetest.csv'),
     filesDir = path.join(__dirname, 'files'),
     testPicture = path.join(filesDir, 'dummy.png');
 
@@ -12,15 +13,21 @@ module.exports = {
             fs.mkdirSync(outputDir);
         }
 
-        if (fs.existsSync(writeTestFile)) {
-            fs.unlinkSync(writeTestFile);
-        }
+        [writeTestFile, writeTestCsvFile].forEach(function(file) {
+            if (fs.existsSync(file)) {
+                fs.unlinkSync(file);
+            }
+        });
     },
 
     getWriteTestFile: function() {
         return writeTestFile;
     },
 
+    getWriteTestCsvFile: function() {
+        return writeTestCsvFile;
+    },
+
     shouldThrow: function(fun, scope) {
         var args = Array.prototype.slice.call(arguments, 2);
 
@@ -41,6 +48,31 @@ module.exports = {
         return true;
     },
 
+    // Minimal AbortSignal stand-in for node versions without AbortController
+    newAbortSignal: function() {
+        var listeners = [];
+
+        return {
+            aborted: false,
+
+            addEventListener: function(type, listener) {
+                listeners.push(listener);
+            },
+
+            removeEventListener: function(type, listener) {
+                var index = listeners.indexOf(listener);
+                if (index >= 0) listeners.splice(index, 1);
+            },
+
+            abort: function() {
+                this.aborted = true;
+                listeners.slice().forEach(function(listener) {
+                    listener();
+                });
+            }
+        };
+    },
+
     testPictureWidth: 640,
     testPictureHeight: 480
 };
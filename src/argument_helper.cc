@@ -26,13 +26,19 @@
 
 #include <sstream>
 
+#include "util.h"
+#include "external_strings.h"
+
 namespace node_libxl {
 
 
 ArgumentHelper::ArgumentHelper(Nan::NAN_METHOD_ARGS_TYPE info) :
     arguments(info),
     exceptionRaised(false)
-{}
+{
+    // Nearly every call into the addon passes here
+    ExternalStringTable::ReportReleasedMemory();
+}
 
 
 int ArgumentHelper::GetInt(uint8_t pos) {
@@ -126,6 +132,154 @@ v8::Local<v8::Value> ArgumentHelper::GetBuffer(uint8_t pos) {
 }
 
 
+v8::Local<v8::Array> ArgumentHelper::GetArray(uint8_t pos) {
+    Nan::EscapableHandleScope scope;
+
+    if (!arguments[pos]->IsArray()) {
+        RaiseException("array required at position", pos);
+        return scope.Escape(Nan::New<v8::Array>());
+    }
+
+    return scope.Escape(arguments[pos].As<v8::Array>());
+}
+
+
+v8::Local<v8::Object> ArgumentHelper::GetObject(uint8_t pos) {
+    Nan::EscapableHandleScope scope;
+
+    if (!arguments[pos]->IsObject()) {
+        RaiseException("object required at position", pos);
+        return scope.Escape(Nan::New<v8::Object>());
+    }
+
+    return scope.Escape(arguments[pos].As<v8::Object>());
+}
+
+
+v8::Local<v8::Object> ArgumentHelper::GetFloat64Array(uint8_t pos) {
+    Nan::EscapableHandleScope scope;
+
+    if (!CSNanIsFloat64Array(arguments[pos])) {
+        RaiseException("Float64Array required at position", pos);
+        return scope.Escape(Nan::New<v8::Object>());
+    }
+
+    return scope.Escape(arguments[pos].As<v8::Object>());
+}
+
+
+v8::Local<v8::Value> ArgumentHelper::GetOption(uint8_t pos, const char* name) {
+    Nan::EscapableHandleScope scope;
+
+    if (arguments[pos]->IsUndefined()) {
+        return scope.Escape(Nan::Undefined());
+    }
+
+    if (!arguments[pos]->IsObject()) {
+        RaiseException("object required at position", pos);
+        return scope.Escape(Nan::Undefined());
+    }
+
+    return scope.Escape(GetProperty(arguments[pos], name));
+}
+
+
+int ArgumentHelper::GetIntOption(uint8_t pos, const char* name, int def) {
+    Nan::HandleScope scope;
+
+    return ToIntOption(GetOption(pos, name), name, def, pos);
+}
+
+
+bool ArgumentHelper::GetBooleanOption(uint8_t pos, const char* name, bool def) {
+    Nan::HandleScope scope;
+
+    v8::Local<v8::Value> value = GetOption(pos, name);
+    if (value->IsUndefined()) return def;
+
+    if (!value->IsBoolean()) {
+        RaiseException(std::string("bool required for option ") + name +
+            " at position", pos);
+        return def;
+    }
+
+    return value->BooleanValue();
+}
+
+
+v8::Local<v8::Value> ArgumentHelper::GetStringOption(uint8_t pos,
+    const char* name, const char* def)
+{
+    Nan::EscapableHandleScope scope;
+
+    v8::Local<v8::Value> value = GetOption(pos, name);
+    if (value->IsUndefined()) {
+        return scope.Escape(Nan::New<v8::String>(def).ToLocalChecked());
+    }
+
+    if (!value->IsString()) {
+        RaiseException(std::string("string required for option ") + name +
+            " at position", pos);
+        return scope.Escape(Nan::New<v8::String>(def).ToLocalChecked());
+    }
+
+    return scope.Escape(value);
+}
+
+
+void ArgumentHelper::GetRange(uint8_t pos, const char* name, int& rowFirst,
+    int& rowLast, int& colFirst, int& colLast)
+{
+    Nan::HandleScope scope;
+
+    v8::Local<v8::Value> range = name ? GetOption(pos, name) : arguments[pos];
+
+    if (!range->IsUndefined() && !range->IsObject()) {
+        RaiseException(name ?
+            std::string("object required for option ") + name + " at position" :
+            std::string("object required at position"), pos);
+    }
+
+    rowFirst    = ToIntOption(GetProperty(range, "rowFirst"), "rowFirst",
+        util::RANGE_DEFAULT, pos);
+    rowLast     = ToIntOption(GetProperty(range, "rowLast"), "rowLast",
+        util::RANGE_DEFAULT, pos);
+    colFirst    = ToIntOption(GetProperty(range, "colFirst"), "colFirst",
+        util::RANGE_DEFAULT, pos);
+    colLast     = ToIntOption(GetProperty(range, "colLast"), "colLast",
+        util::RANGE_DEFAULT, pos);
+}
+
+
+v8::Local<v8::Value> ArgumentHelper::GetProperty(v8::Local<v8::Value> object,
+    const char* name)
+{
+    Nan::EscapableHandleScope scope;
+
+    if (!object->IsObject()) {
+        return scope.Escape(Nan::Undefined());
+    }
+
+    return scope.Escape(object.As<v8::Object>()->Get(
+        Nan::New<v8::String>(name).ToLocalChecked()));
+}
+
+
+int ArgumentHelper::ToIntOption(v8::Local<v8::Value> value, const char* name,
+    int def, uint8_t pos)
+{
+    if (value->IsUndefined()) return def;
+
+    if (!value->IsInt32()) {
+        RaiseException(std::string("integer required for option ") + name +
+            " at position", pos);
+        return def;
+    }
+
+    return value->IntegerValue();
+}
+
+
 void ArgumentHelper::RaiseException(const std::string& message, int32_t pos) {
     Nan::EscapableHandleScope scope;
 
@@ -53,9 +53,30 @@ class ArgumentHelper {
 
         v8::Local<v8::Value> GetBuffer(uint8_t pos);
 
+        v8::Local<v8::Array> GetArray(uint8_t pos);
+
+        v8::Local<v8::Object> GetObject(uint8_t pos);
+
+        v8::Local<v8::Object> GetFloat64Array(uint8_t pos);
+
+        v8::Local<v8::Value> GetOption(uint8_t pos, const char* name);
+        int GetIntOption(uint8_t pos, const char* name, int def);
+        bool GetBooleanOption(uint8_t pos, const char* name, bool def);
+        v8::Local<v8::Value> GetStringOption(uint8_t pos, const char* name,
+            const char* def);
+
+        // Reads a {rowFirst, rowLast, colFirst, colLast} range, either from
+        // the argument itself (name == NULL) or from the option with the
+        // given name. Missing bounds are set to util::RANGE_DEFAULT.
+        void GetRange(uint8_t pos, const char* name, int& rowFirst,
+            int& rowLast, int& colFirst, int& colLast);
+
         template<typename T> T* GetWrapped(uint8_t pos);
         template<typename T> T* GetWrapped(uint8_t pos, T* def);
 
+        // Returns NULL if the option is missing
+        template<typename T> T* GetWrappedOption(uint8_t pos, const char* name);
+
         bool HasException() const;
         Nan::NAN_METHOD_RETURN_TYPE ThrowException() const;
 
@@ -67,6 +88,11 @@ class ArgumentHelper {
 
         void RaiseException(const std::string& message, int32_t pos = -1);
 
+        v8::Local<v8::Value> GetProperty(v8::Local<v8::Value> object,
+            const char* name);
+        int ToIntOption(v8::Local<v8::Value> value, const char* name, int def,
+            uint8_t pos);
+
         ArgumentHelper(const ArgumentHelper&);
         const ArgumentHelper& operator=(ArgumentHelper&);
 };
@@ -86,6 +112,24 @@ template<typename T> T* ArgumentHelper::GetWrapped(uint8_t pos, T* def) {
 }
 
 
+template<typename T> T* ArgumentHelper::GetWrappedOption(uint8_t pos,
+    const char* name)
+{
+    Nan::HandleScope scope;
+
+    v8::Local<v8::Value> value = GetOption(pos, name);
+    if (value->IsUndefined()) return NULL;
+
+    T* unwrapped = T::Unwrap(value);
+    if (!unwrapped) {
+        RaiseException(std::string("Invalid type for option ") + name +
+            " at position", pos);
+    }
+
+    return unwrapped;
+}
+
+
 }
 
 #endif // BINDINGS_ARGUMENT_HELPER_H
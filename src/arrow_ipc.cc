@@ -0,0 +1,1329 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 Christian Speckner <cnspeckn@googlemail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "arrow_ipc.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "util.h"
+
+namespace node_libxl {
+
+
+namespace {
+
+
+// Constants from Schema.fbs and Message.fbs of the Arrow format
+// specification
+const uint32_t CONTINUATION_MARKER = 0xFFFFFFFF;
+const int16_t METADATA_VERSION_V5 = 4;
+
+enum {
+    MESSAGE_HEADER_SCHEMA           = 1,
+    MESSAGE_HEADER_DICTIONARY_BATCH = 2,
+    MESSAGE_HEADER_RECORD_BATCH     = 3
+};
+
+enum {
+    TYPE_NULL           = 1,
+    TYPE_INT            = 2,
+    TYPE_FLOATING_POINT = 3,
+    TYPE_UTF8           = 5,
+    TYPE_BOOL           = 6,
+    TYPE_DATE           = 8,
+    TYPE_TIMESTAMP      = 10
+};
+
+enum {PRECISION_HALF, PRECISION_SINGLE, PRECISION_DOUBLE};
+enum {DATE_UNIT_DAY, DATE_UNIT_MILLISECOND};
+enum {
+    TIME_UNIT_SECOND,
+    TIME_UNIT_MILLISECOND,
+    TIME_UNIT_MICROSECOND,
+    TIME_UNIT_NANOSECOND
+};
+
+// Field ids of the flatbuffer tables. A union takes up two ids, one for the
+// type tag and one for the value.
+enum {
+    MESSAGE_VERSION,
+    MESSAGE_HEADER_TYPE,
+    MESSAGE_HEADER,
+    MESSAGE_BODY_LENGTH
+};
+
+enum {SCHEMA_ENDIANNESS, SCHEMA_FIELDS};
+
+enum {
+    FIELD_NAME,
+    FIELD_NULLABLE,
+    FIELD_TYPE_TYPE,
+    FIELD_TYPE,
+    FIELD_DICTIONARY,
+    FIELD_CHILDREN
+};
+
+enum {
+    RECORD_BATCH_LENGTH,
+    RECORD_BATCH_NODES,
+    RECORD_BATCH_BUFFERS,
+    RECORD_BATCH_COMPRESSION
+};
+
+enum {INT_BIT_WIDTH, INT_IS_SIGNED};
+
+// Precision of FloatingPoint, unit of Date and Timestamp
+const uint16_t TYPE_UNIT = 0;
+
+
+struct FieldNode {
+    int64_t length, nullCount;
+};
+
+
+struct BufferSpec {
+    int64_t offset, length;
+};
+
+
+// Excel serial dates count days from 1899-12-30 (or 1904-01-01 for books
+// using the 1904 date system), the epoch falls on these serials
+const double EPOCH_SERIAL_1900 = 25569;
+const double EPOCH_SERIAL_1904 = 24107;
+const double MS_PER_DAY = 86400000;
+
+// Rows per record batch. Batches are cut short if the text of an utf8 column
+// would overflow its int32 offsets, see ReadTextColumns.
+const int BATCH_ROWS = 65536;
+const size_t MAX_TEXT_BYTES = std::numeric_limits<int32_t>::max();
+
+
+size_t Align(size_t size) {
+    return (size + 7) & ~static_cast<size_t>(7);
+}
+
+
+template<typename T> T Load(const uint8_t* data) {
+    T value;
+    memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+
+bool GetBit(const uint8_t* bitmap, int64_t index) {
+    return (bitmap[index >> 3] >> (index & 7)) & 1;
+}
+
+
+void SetBit(uint8_t* bitmap, int64_t index) {
+    bitmap[index >> 3] |= 1 << (index & 7);
+}
+
+
+// Minimal flatbuffer builder. Objects are written front to back: a table
+// reserves its offset fields, and the referenced objects are appended later
+// and linked with SetOffset. This works as flatbuffer offsets always point
+// towards the end of the buffer.
+class FlatBufferBuilder {
+    public:
+
+        FlatBufferBuilder() : data(sizeof(uint32_t), 0) {}
+
+        const std::vector<char>& Data() const {
+            return data;
+        }
+
+        size_t Size() const {
+            return data.size();
+        }
+
+        void Pad(size_t alignment) {
+            data.resize((data.size() + alignment - 1) / alignment * alignment, 0);
+        }
+
+        size_t Append(const void* bytes, size_t size) {
+            size_t position = data.size();
+
+            data.resize(position + size);
+            if (size > 0) memcpy(&data[position], bytes, size);
+
+            return position;
+        }
+
+        template<typename T> size_t AppendScalar(T value) {
+            return Append(&value, sizeof(T));
+        }
+
+        void Set(size_t position, const void* bytes, size_t size) {
+            memcpy(&data[position], bytes, size);
+        }
+
+        void SetOffset(size_t position, size_t target) {
+            uint32_t offset = target - position;
+            Set(position, &offset, sizeof(offset));
+        }
+
+        void SetRoot(size_t table) {
+            SetOffset(0, table);
+        }
+
+        size_t String(const std::string& value) {
+            Pad(sizeof(uint32_t));
+
+            size_t position = AppendScalar<uint32_t>(value.size());
+            Append(value.data(), value.size());
+            AppendScalar<char>(0);
+
+            return position;
+        }
+
+        // Vector of tables, the elements are linked with SetOffset
+        size_t OffsetVector(uint32_t count) {
+            Pad(sizeof(uint32_t));
+
+            size_t position = AppendScalar<uint32_t>(count);
+            data.resize(data.size() + count * sizeof(uint32_t), 0);
+
+            return position;
+        }
+
+        static size_t OffsetVectorElement(size_t vector, uint32_t index) {
+            return vector + (index + 1) * sizeof(uint32_t);
+        }
+
+        // Vector of structs with 8 byte alignment
+        size_t StructVector(const void* elements, uint32_t count,
+            size_t elementSize)
+        {
+            Pad(8);
+            AppendScalar<uint32_t>(0);
+
+            size_t position = AppendScalar<uint32_t>(count);
+            Append(elements, count * elementSize);
+
+            return position;
+        }
+
+    private:
+
+        std::vector<char> data;
+};
+
+
+class TableBuilder {
+    public:
+
+        explicit TableBuilder(FlatBufferBuilder& builder) :
+            builder(builder),
+            position(0)
+        {}
+
+        template<typename T> void AddScalar(uint16_t id, T value) {
+            Field field;
+
+            field.id = id;
+            field.size = sizeof(T);
+            field.offset = 0;
+            memcpy(field.value, &value, sizeof(T));
+
+            fields.push_back(field);
+        }
+
+        // Reserves an offset which is linked with FlatBufferBuilder::SetOffset
+        // once the table is finished
+        void AddOffset(uint16_t id) {
+            AddScalar<uint32_t>(id, 0);
+        }
+
+        // Writes vtable and table, returns the position of the table
+        size_t Finish() {
+            uint16_t fieldCount = 0;
+            size_t tableSize = sizeof(int32_t);
+
+            // Placing the fields by decreasing size keeps them aligned with a
+            // minimum of padding
+            for (size_t size = 8; size > 0; size /= 2) {
+                for (size_t i = 0; i < fields.size(); i++) {
+                    if (fields[i].size != size) continue;
+
+                    tableSize = (tableSize + size - 1) / size * size;
+                    fields[i].offset = tableSize;
+                    tableSize += size;
+                }
+            }
+
+            for (size_t i = 0; i < fields.size(); i++) {
+                if (fields[i].id >= fieldCount) fieldCount = fields[i].id + 1;
+            }
+
+            builder.Pad(sizeof(uint16_t));
+            size_t vtable = builder.AppendScalar<uint16_t>(
+                (fieldCount + 2) * sizeof(uint16_t));
+            builder.AppendScalar<uint16_t>(tableSize);
+
+            for (uint16_t id = 0; id < fieldCount; id++) {
+                uint16_t offset = 0;
+
+                for (size_t i = 0; i < fields.size(); i++) {
+                    if (fields[i].id == id) offset = fields[i].offset;
+                }
+
+                builder.AppendScalar<uint16_t>(offset);
+            }
+
+            builder.Pad(8);
+            position = builder.AppendScalar<int32_t>(builder.Size() - vtable);
+
+            std::vector<char> table(tableSize - sizeof(int32_t), 0);
+            builder.Append(table.empty() ? NULL : &table[0], table.size());
+
+            for (size_t i = 0; i < fields.size(); i++) {
+                builder.Set(position + fields[i].offset, fields[i].value,
+                    fields[i].size);
+            }
+
+            return position;
+        }
+
+        size_t FieldPosition(uint16_t id) const {
+            for (size_t i = 0; i < fields.size(); i++) {
+                if (fields[i].id == id) return position + fields[i].offset;
+            }
+
+            return 0;
+        }
+
+    private:
+
+        struct Field {
+            uint16_t id;
+            size_t size, offset;
+            char value[8];
+        };
+
+        FlatBufferBuilder& builder;
+        std::vector<Field> fields;
+        size_t position;
+};
+
+
+// Bounds checked access to the tables of a flatbuffer
+class TableReader {
+    public:
+
+        TableReader() :
+            data(NULL),
+            size(0),
+            position(0),
+            vtable(0),
+            vtableSize(0),
+            tableSize(0)
+        {}
+
+        bool InitRoot(const uint8_t* data, size_t size) {
+            uint32_t root;
+
+            this->data = data;
+            this->size = size;
+
+            return Read(0, root) && Init(root);
+        }
+
+        template<typename T> T Scalar(uint16_t id, T def) const {
+            size_t field = Field(id);
+            T value;
+
+            return field && Read(field, value) ? value : def;
+        }
+
+        bool Table(uint16_t id, TableReader& table) const {
+            size_t target;
+            return Dereference(Field(id), target) && TableAt(target, table);
+        }
+
+        bool VectorTable(size_t element, TableReader& table) const {
+            size_t target;
+            return Dereference(element, target) && TableAt(target, table);
+        }
+
+        // Locates the elements of a vector and checks that they are within
+        // the buffer
+        bool Vector(uint16_t id, size_t elementSize, size_t& elements,
+            uint32_t& count) const
+        {
+            size_t target;
+
+            if (!Dereference(Field(id), target) || !Read(target, count)) {
+                return false;
+            }
+
+            elements = target + sizeof(uint32_t);
+            return count <= (size - elements) / elementSize;
+        }
+
+        bool String(uint16_t id, std::string& value) const {
+            size_t elements;
+            uint32_t count;
+
+            if (!Vector(id, 1, elements, count)) return false;
+
+            value.assign(reinterpret_cast<const char*>(data + elements), count);
+            return true;
+        }
+
+        template<typename T> bool Read(size_t at, T& value) const {
+            if (at > size || size - at < sizeof(T)) return false;
+
+            memcpy(&value, data + at, sizeof(T));
+            return true;
+        }
+
+    private:
+
+        bool Init(size_t at) {
+            int32_t vtableOffset;
+
+            if (!Read(at, vtableOffset)) return false;
+
+            int64_t vtablePosition = static_cast<int64_t>(at) - vtableOffset;
+            if (vtablePosition <= 0 ||
+                vtablePosition >= static_cast<int64_t>(size))
+            {
+                return false;
+            }
+
+            position = at;
+            vtable = static_cast<size_t>(vtablePosition);
+
+            return Read(vtable, vtableSize) &&
+                Read(vtable + sizeof(uint16_t), tableSize) &&
+                vtableSize >= 2 * sizeof(uint16_t) &&
+                vtableSize <= size - vtable &&
+                tableSize <= size - position;
+        }
+
+        bool TableAt(size_t at, TableReader& table) const {
+            TableReader result(*this);
+
+            if (!result.Init(at)) return false;
+
+            table = result;
+            return true;
+        }
+
+        // Position of a field, 0 if the field is not present
+        size_t Field(uint16_t id) const {
+            size_t entry = (id + 2) * sizeof(uint16_t);
+            uint16_t offset;
+
+            if (entry + sizeof(uint16_t) > vtableSize ||
+                !Read(vtable + entry, offset) ||
+                offset == 0 || offset >= tableSize)
+            {
+                return 0;
+            }
+
+            return position + offset;
+        }
+
+        bool Dereference(size_t field, size_t& target) const {
+            uint32_t offset;
+
+            if (!field || !Read(field, offset) || offset > size - field) {
+                return false;
+            }
+
+            target = field + offset;
+            return true;
+        }
+
+        const uint8_t* data;
+        size_t size, position, vtable;
+        uint16_t vtableSize, tableSize;
+};
+
+
+// Adds the message table as the root of the builder, returns the position
+// of the header offset
+size_t AddMessage(FlatBufferBuilder& builder, uint8_t headerType,
+    int64_t bodyLength)
+{
+    TableBuilder message(builder);
+
+    message.AddScalar<int16_t>(MESSAGE_VERSION, METADATA_VERSION_V5);
+    message.AddScalar<uint8_t>(MESSAGE_HEADER_TYPE, headerType);
+    message.AddOffset(MESSAGE_HEADER);
+    message.AddScalar<int64_t>(MESSAGE_BODY_LENGTH, bodyLength);
+
+    builder.SetRoot(message.Finish());
+
+    return message.FieldPosition(MESSAGE_HEADER);
+}
+
+
+// Encapsulated message: continuation marker, metadata size, metadata padded
+// to 8 bytes, body
+void AppendMessage(std::vector<char>& stream, FlatBufferBuilder& metadata,
+    const std::vector<char>& body)
+{
+    metadata.Pad(8);
+
+    uint32_t prefix[2] = {
+        CONTINUATION_MARKER,
+        static_cast<uint32_t>(metadata.Size())
+    };
+
+    stream.insert(stream.end(), reinterpret_cast<char*>(prefix),
+        reinterpret_cast<char*>(prefix) + sizeof(prefix));
+    stream.insert(stream.end(), metadata.Data().begin(), metadata.Data().end());
+    stream.insert(stream.end(), body.begin(), body.end());
+}
+
+
+// Appends a zero filled buffer to a record batch body
+size_t AddBuffer(std::vector<char>& body, std::vector<BufferSpec>& buffers,
+    size_t size)
+{
+    BufferSpec buffer = {
+        static_cast<int64_t>(body.size()),
+        static_cast<int64_t>(size)
+    };
+
+    buffers.push_back(buffer);
+    body.resize(body.size() + Align(size), 0);
+
+    return body.size() - Align(size);
+}
+
+
+enum ColumnType {
+    COLUMN_FLOAT64,
+    COLUMN_TIMESTAMP,
+    COLUMN_BOOL,
+    COLUMN_UTF8
+};
+
+
+struct ExportColumn {
+    std::string name;
+    ColumnType type;
+};
+
+
+// Spreadsheet style column name (A, B, ..., Z, AA, ...)
+std::string ColumnName(int col) {
+    std::string name;
+
+    for (col++; col > 0; col = (col - 1) / 26) {
+        name.insert(name.begin(), static_cast<char>('A' + (col - 1) % 26));
+    }
+
+    return name;
+}
+
+
+// Appends the text representation of a cell. Returns false on libxl errors,
+// empty, blank and error cells are flagged with isNull.
+bool AppendText(libxl::Sheet* sheet, int row, int col, std::string& text,
+    bool& isNull)
+{
+    isNull = false;
+
+    switch (sheet->cellType(row, col)) {
+        case libxl::CELLTYPE_STRING: {
+            const char* value = sheet->readStr(row, col);
+            if (!value) return false;
+
+            text.append(value);
+            return true;
+        }
+
+        case libxl::CELLTYPE_NUMBER: {
+            char buffer[util::NUMBER_BUFFER_SIZE];
+            text.append(buffer, util::FormatNumber(
+                sheet->readNum(row, col), buffer));
+
+            return true;
+        }
+
+        case libxl::CELLTYPE_BOOLEAN:
+            text.append(sheet->readBool(row, col) ? "true" : "false");
+            return true;
+
+        default:
+            isNull = true;
+            return true;
+    }
+}
+
+
+bool ReadColumns(libxl::Sheet* sheet, int rowFirst, int rowLast,
+    int colFirst, int colLast, bool headerRow,
+    std::vector<ExportColumn>& columns)
+{
+    enum {SEEN_NUMBER = 1, SEEN_DATE = 2, SEEN_BOOLEAN = 4, SEEN_STRING = 8};
+
+    for (int col = colFirst; col <= colLast; col++) {
+        ExportColumn column;
+        bool isNull;
+        int seen = 0;
+
+        if (headerRow && rowFirst <= rowLast &&
+            !AppendText(sheet, rowFirst, col, column.name, isNull))
+        {
+            return false;
+        }
+
+        if (column.name.empty()) column.name = ColumnName(col);
+
+        for (int row = headerRow ? rowFirst + 1 : rowFirst; row <= rowLast; row++) {
+            switch (sheet->cellType(row, col)) {
+                case libxl::CELLTYPE_NUMBER:
+                    seen |= sheet->isDate(row, col) ? SEEN_DATE : SEEN_NUMBER;
+                    break;
+
+                case libxl::CELLTYPE_BOOLEAN:
+                    seen |= SEEN_BOOLEAN;
+                    break;
+
+                case libxl::CELLTYPE_STRING:
+                    seen |= SEEN_STRING;
+                    break;
+
+                default:
+                    break;
+            }
+        }
+
+        // Mixed columns and columns without any values fall back to utf8
+        if (seen == SEEN_DATE) {
+            column.type = COLUMN_TIMESTAMP;
+        } else if (seen == SEEN_BOOLEAN) {
+            column.type = COLUMN_BOOL;
+        } else if (seen != 0 && (seen & (SEEN_BOOLEAN | SEEN_STRING)) == 0) {
+            column.type = COLUMN_FLOAT64;
+        } else {
+            column.type = COLUMN_UTF8;
+        }
+
+        columns.push_back(column);
+    }
+
+    return true;
+}
+
+
+void AppendSchema(std::vector<char>& stream,
+    const std::vector<ExportColumn>& columns)
+{
+    static const uint8_t arrowTypes[] = {
+        TYPE_FLOATING_POINT, TYPE_TIMESTAMP, TYPE_BOOL, TYPE_UTF8
+    };
+
+    FlatBufferBuilder builder;
+    size_t header = AddMessage(builder, MESSAGE_HEADER_SCHEMA, 0);
+
+    TableBuilder schema(builder);
+    schema.AddScalar<int16_t>(SCHEMA_ENDIANNESS, 0);
+    schema.AddOffset(SCHEMA_FIELDS);
+    builder.SetOffset(header, schema.Finish());
+
+    size_t fields = builder.OffsetVector(columns.size());
+    builder.SetOffset(schema.FieldPosition(SCHEMA_FIELDS), fields);
+
+    for (uint32_t i = 0; i < columns.size(); i++) {
+        TableBuilder field(builder);
+
+        field.AddOffset(FIELD_NAME);
+        field.AddScalar<uint8_t>(FIELD_NULLABLE, 1);
+        field.AddScalar<uint8_t>(FIELD_TYPE_TYPE, arrowTypes[columns[i].type]);
+        field.AddOffset(FIELD_TYPE);
+        field.AddOffset(FIELD_CHILDREN);
+        builder.SetOffset(FlatBufferBuilder::OffsetVectorElement(fields, i),
+            field.Finish());
+
+        builder.SetOffset(field.FieldPosition(FIELD_NAME),
+            builder.String(columns[i].name));
+
+        TableBuilder type(builder);
+        if (columns[i].type == COLUMN_FLOAT64) {
+            type.AddScalar<int16_t>(TYPE_UNIT, PRECISION_DOUBLE);
+        } else if (columns[i].type == COLUMN_TIMESTAMP) {
+            type.AddScalar<int16_t>(TYPE_UNIT, TIME_UNIT_MILLISECOND);
+        }
+        builder.SetOffset(field.FieldPosition(FIELD_TYPE), type.Finish());
+
+        builder.SetOffset(field.FieldPosition(FIELD_CHILDREN),
+            builder.OffsetVector(0));
+    }
+
+    AppendMessage(stream, builder, std::vector<char>());
+}
+
+
+// Text and arrow offsets of an utf8 column within a record batch
+struct TextColumn {
+    std::string text;
+    std::vector<int32_t> ends;
+    std::vector<bool> nulls;
+};
+
+
+// Reads the utf8 columns of a batch. libxl limits strings to 32767
+// characters, but with multibyte characters a full batch may still hold more
+// text than int32 offsets can address, so length is reduced to the rows
+// whose text fits into every column.
+bool ReadTextColumns(libxl::Sheet* sheet,
+    const std::vector<ExportColumn>& columns, int colFirst, int batchFirst,
+    int64_t& length, std::vector<TextColumn>& texts)
+{
+    texts.resize(columns.size());
+
+    for (size_t i = 0; i < columns.size(); i++) {
+        if (columns[i].type != COLUMN_UTF8) continue;
+
+        TextColumn& column = texts[i];
+        column.ends.assign(1, 0);
+
+        for (int64_t j = 0; j < length; j++) {
+            size_t size = column.text.size();
+            bool isNull;
+
+            if (!AppendText(sheet, batchFirst + j, colFirst + i, column.text,
+                isNull))
+            {
+                return false;
+            }
+
+            if (column.text.size() > MAX_TEXT_BYTES) {
+                if (j == 0) return false;
+
+                column.text.resize(size);
+                length = j;
+                break;
+            }
+
+            column.ends.push_back(static_cast<int32_t>(column.text.size()));
+            column.nulls.push_back(isNull);
+        }
+    }
+
+    return true;
+}
+
+
+// Appends a record batch for the rows batchFirst..batchLast. If the batch has
+// to be cut short, batchLast is set to its last row.
+bool AppendRecordBatch(std::vector<char>& stream, libxl::Sheet* sheet,
+    const std::vector<ExportColumn>& columns, int colFirst, int batchFirst,
+    int& batchLast, double epochSerial)
+{
+    int64_t length = batchLast - batchFirst + 1;
+    std::vector<TextColumn> texts;
+
+    if (!ReadTextColumns(sheet, columns, colFirst, batchFirst, length, texts)) {
+        return false;
+    }
+
+    batchLast = batchFirst + static_cast<int>(length) - 1;
+    size_t bitmapSize = (length + 7) / 8;
+
+    std::vector<char> body;
+    std::vector<FieldNode> nodes(columns.size());
+    std::vector<BufferSpec> buffers;
+
+    for (size_t i = 0; i < columns.size(); i++) {
+        int col = colFirst + i;
+        FieldNode& node = nodes[i];
+
+        node.length = length;
+        node.nullCount = 0;
+
+        size_t validity = AddBuffer(body, buffers, bitmapSize);
+
+        switch (columns[i].type) {
+            case COLUMN_FLOAT64:
+            case COLUMN_TIMESTAMP: {
+                size_t values = AddBuffer(body, buffers, length * sizeof(double));
+                uint8_t* bitmap = reinterpret_cast<uint8_t*>(&body[validity]);
+                char* data = &body[values];
+
+                for (int64_t j = 0; j < length; j++) {
+                    int row = batchFirst + j;
+
+                    if (sheet->cellType(row, col) != libxl::CELLTYPE_NUMBER) {
+                        node.nullCount++;
+                        continue;
+                    }
+
+                    double value = sheet->readNum(row, col);
+
+                    if (columns[i].type == COLUMN_TIMESTAMP) {
+                        int64_t timestamp = static_cast<int64_t>(
+                            floor((value - epochSerial) * MS_PER_DAY + 0.5));
+                        memcpy(data + j * sizeof(int64_t), &timestamp,
+                            sizeof(int64_t));
+                    } else {
+                        memcpy(data + j * sizeof(double), &value, sizeof(double));
+                    }
+
+                    SetBit(bitmap, j);
+                }
+
+                break;
+            }
+
+            case COLUMN_BOOL: {
+                size_t values = AddBuffer(body, buffers, bitmapSize);
+                uint8_t* bitmap = reinterpret_cast<uint8_t*>(&body[validity]);
+                uint8_t* data = reinterpret_cast<uint8_t*>(&body[values]);
+
+                for (int64_t j = 0; j < length; j++) {
+                    int row = batchFirst + j;
+
+                    if (sheet->cellType(row, col) != libxl::CELLTYPE_BOOLEAN) {
+                        node.nullCount++;
+                        continue;
+                    }
+
+                    if (sheet->readBool(row, col)) SetBit(data, j);
+                    SetBit(bitmap, j);
+                }
+
+                break;
+            }
+
+            case COLUMN_UTF8: {
+                const TextColumn& column = texts[i];
+                size_t offsets = AddBuffer(body, buffers,
+                    (length + 1) * sizeof(int32_t));
+                uint8_t* bitmap = reinterpret_cast<uint8_t*>(&body[validity]);
+
+                memcpy(&body[offsets], &column.ends[0],
+                    (length + 1) * sizeof(int32_t));
+
+                for (int64_t j = 0; j < length; j++) {
+                    if (column.nulls[j]) {
+                        node.nullCount++;
+                    } else {
+                        SetBit(bitmap, j);
+                    }
+                }
+
+                size_t textSize = column.ends[length];
+                size_t values = AddBuffer(body, buffers, textSize);
+                if (textSize > 0) memcpy(&body[values], column.text.data(), textSize);
+
+                break;
+            }
+        }
+    }
+
+    FlatBufferBuilder builder;
+    size_t header = AddMessage(builder, MESSAGE_HEADER_RECORD_BATCH, body.size());
+
+    TableBuilder batch(builder);
+    batch.AddScalar<int64_t>(RECORD_BATCH_LENGTH, length);
+    batch.AddOffset(RECORD_BATCH_NODES);
+    batch.AddOffset(RECORD_BATCH_BUFFERS);
+    builder.SetOffset(header, batch.Finish());
+
+    builder.SetOffset(batch.FieldPosition(RECORD_BATCH_NODES),
+        builder.StructVector(nodes.empty() ? NULL : &nodes[0], nodes.size(),
+            sizeof(FieldNode)));
+    builder.SetOffset(batch.FieldPosition(RECORD_BATCH_BUFFERS),
+        builder.StructVector(buffers.empty() ? NULL : &buffers[0],
+            buffers.size(), sizeof(BufferSpec)));
+
+    AppendMessage(stream, builder, body);
+
+    return true;
+}
+
+
+struct ImportColumn {
+    std::string name;
+    uint8_t type;
+    int16_t unit;
+    int32_t bitWidth;
+    bool isSigned;
+};
+
+
+const char* const ERROR_INVALID = "invalid arrow stream";
+const char* const ERROR_UNSUPPORTED_TYPE = "unsupported arrow column type";
+const char* const ERROR_DICTIONARY = "dictionary encoded arrow columns are not supported";
+const char* const ERROR_COMPRESSION = "compressed arrow record batches are not supported";
+
+
+const char* ReadSchema(const TableReader& message,
+    std::vector<ImportColumn>& columns)
+{
+    TableReader schema;
+    size_t fields;
+    uint32_t fieldCount;
+
+    if (!message.Table(MESSAGE_HEADER, schema) ||
+        !schema.Vector(SCHEMA_FIELDS, sizeof(uint32_t), fields, fieldCount))
+    {
+        return ERROR_INVALID;
+    }
+
+    columns.resize(fieldCount);
+
+    for (uint32_t i = 0; i < fieldCount; i++) {
+        TableReader field, type, dictionary;
+        ImportColumn& column = columns[i];
+
+        if (!schema.VectorTable(fields + i * sizeof(uint32_t), field)) {
+            return ERROR_INVALID;
+        }
+
+        if (field.Table(FIELD_DICTIONARY, dictionary)) return ERROR_DICTIONARY;
+
+        field.String(FIELD_NAME, column.name);
+        field.Table(FIELD_TYPE, type);
+
+        column.type = field.Scalar<uint8_t>(FIELD_TYPE_TYPE, 0);
+        column.unit = 0;
+        column.bitWidth = 0;
+        column.isSigned = false;
+
+        switch (column.type) {
+            case TYPE_NULL:
+            case TYPE_UTF8:
+            case TYPE_BOOL:
+                break;
+
+            case TYPE_INT:
+                column.bitWidth = type.Scalar<int32_t>(INT_BIT_WIDTH, 0);
+                column.isSigned = type.Scalar<uint8_t>(INT_IS_SIGNED, 0) != 0;
+
+                if (column.bitWidth != 8 && column.bitWidth != 16 &&
+                    column.bitWidth != 32 && column.bitWidth != 64)
+                {
+                    return ERROR_INVALID;
+                }
+
+                break;
+
+            case TYPE_FLOATING_POINT:
+                column.unit = type.Scalar<int16_t>(TYPE_UNIT, PRECISION_HALF);
+                if (column.unit == PRECISION_HALF) return ERROR_UNSUPPORTED_TYPE;
+                break;
+
+            case TYPE_DATE:
+                column.unit = type.Scalar<int16_t>(TYPE_UNIT, DATE_UNIT_MILLISECOND);
+                break;
+
+            case TYPE_TIMESTAMP:
+                column.unit = type.Scalar<int16_t>(TYPE_UNIT, TIME_UNIT_SECOND);
+                break;
+
+            default:
+                return ERROR_UNSUPPORTED_TYPE;
+        }
+    }
+
+    return NULL;
+}
+
+
+// Size of the data buffer for a column of the given length, the validity and
+// bool bitmaps are accounted for separately
+int64_t DataSize(const ImportColumn& column, int64_t length) {
+    switch (column.type) {
+        case TYPE_INT:
+            return length * (column.bitWidth / 8);
+
+        case TYPE_FLOATING_POINT:
+            return length * (column.unit == PRECISION_SINGLE ? 4 : 8);
+
+        case TYPE_DATE:
+            return length * (column.unit == DATE_UNIT_DAY ? 4 : 8);
+
+        case TYPE_TIMESTAMP:
+            return length * 8;
+
+        case TYPE_BOOL:
+            return (length + 7) / 8;
+
+        case TYPE_UTF8:
+            return (length + 1) * 4;
+
+        default:
+            return 0;
+    }
+}
+
+
+double NumericValue(const ImportColumn& column, const uint8_t* data,
+    int64_t index)
+{
+    static const double unitsPerDay[] = {86400, 86400e3, 86400e6, 86400e9};
+
+    switch (column.type) {
+        case TYPE_INT:
+            if (column.isSigned) {
+                switch (column.bitWidth) {
+                    case 8:  return Load<int8_t>(data + index);
+                    case 16: return Load<int16_t>(data + index * 2);
+                    case 32: return Load<int32_t>(data + index * 4);
+                    default: return Load<int64_t>(data + index * 8);
+                }
+            }
+
+            switch (column.bitWidth) {
+                case 8:  return Load<uint8_t>(data + index);
+                case 16: return Load<uint16_t>(data + index * 2);
+                case 32: return Load<uint32_t>(data + index * 4);
+                default: return Load<uint64_t>(data + index * 8);
+            }
+
+        case TYPE_FLOATING_POINT:
+            return column.unit == PRECISION_SINGLE ?
+                Load<float>(data + index * 4) : Load<double>(data + index * 8);
+
+        case TYPE_DATE:
+            return column.unit == DATE_UNIT_DAY ?
+                Load<int32_t>(data + index * 4) :
+                Load<int64_t>(data + index * 8) / MS_PER_DAY;
+
+        case TYPE_TIMESTAMP:
+            return Load<int64_t>(data + index * 8) /
+                unitsPerDay[column.unit >= TIME_UNIT_SECOND &&
+                    column.unit <= TIME_UNIT_NANOSECOND ? column.unit : 0];
+
+        default:
+            return 0;
+    }
+}
+
+
+}
+
+
+ArrowWriter::ArrowWriter(int rowFirst, int rowLast, int colFirst, int colLast,
+        bool headerRow) :
+    rowFirst(rowFirst),
+    rowLast(rowLast),
+    colFirst(colFirst),
+    colLast(colLast),
+    headerRow(headerRow)
+{}
+
+
+bool ArrowWriter::Write(libxl::Book* book, libxl::Sheet* sheet) {
+    std::vector<ExportColumn> columns;
+
+    stream.clear();
+    util::ResolveRange(sheet, rowFirst, rowLast, colFirst, colLast);
+
+    if (!ReadColumns(sheet, rowFirst, rowLast, colFirst, colLast, headerRow,
+        columns))
+    {
+        return false;
+    }
+
+    AppendSchema(stream, columns);
+
+    double epochSerial = book->isDate1904() ?
+        EPOCH_SERIAL_1904 : EPOCH_SERIAL_1900;
+    int batchFirst = headerRow ? rowFirst + 1 : rowFirst;
+
+    while (batchFirst <= rowLast) {
+        int batchLast = rowLast - batchFirst >= BATCH_ROWS ?
+            batchFirst + BATCH_ROWS - 1 : rowLast;
+
+        if (!AppendRecordBatch(stream, sheet, columns, colFirst, batchFirst,
+            batchLast, epochSerial))
+        {
+            return false;
+        }
+
+        if (batchLast == rowLast) break;
+        batchFirst = batchLast + 1;
+    }
+
+    uint32_t endOfStream[2] = {CONTINUATION_MARKER, 0};
+    stream.insert(stream.end(), reinterpret_cast<char*>(endOfStream),
+        reinterpret_cast<char*>(endOfStream) + sizeof(endOfStream));
+
+    return true;
+}
+
+
+const std::vector<char>& ArrowWriter::Stream() const {
+    return stream;
+}
+
+
+ArrowReader::ArrowReader(int row, int col, bool headerRow) :
+    row(row),
+    col(col),
+    headerRow(headerRow),
+    errorMessage(NULL)
+{}
+
+
+const char* ArrowReader::ErrorMessage() const {
+    return errorMessage;
+}
+
+
+bool ArrowReader::Read(libxl::Book* book, libxl::Sheet* sheet,
+    const char* data, size_t size)
+{
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+    std::vector<ImportColumn> columns;
+    bool hasSchema = false;
+    int nextRow = headerRow ? row + 1 : row;
+    double epochSerial = book->isDate1904() ?
+        EPOCH_SERIAL_1904 : EPOCH_SERIAL_1900;
+    libxl::Format *dateFormat = NULL, *timestampFormat = NULL;
+    std::string text;
+    size_t position = 0;
+
+    errorMessage = NULL;
+
+    // A missing end of stream marker is tolerated
+    while (size - position >= sizeof(uint32_t)) {
+        uint32_t metadataSize = Load<uint32_t>(bytes + position);
+        position += sizeof(uint32_t);
+
+        // Streams written before Arrow 0.15 omit the continuation marker
+        if (metadataSize == CONTINUATION_MARKER) {
+            if (size - position < sizeof(uint32_t)) {
+                errorMessage = ERROR_INVALID;
+                return false;
+            }
+
+            metadataSize = Load<uint32_t>(bytes + position);
+            position += sizeof(uint32_t);
+        }
+
+        if (metadataSize == 0) break;
+
+        TableReader message;
+        if (metadataSize > size - position ||
+            !message.InitRoot(bytes + position, metadataSize))
+        {
+            errorMessage = ERROR_INVALID;
+            return false;
+        }
+
+        position += metadataSize;
+
+        int64_t bodyLength = message.Scalar<int64_t>(MESSAGE_BODY_LENGTH, 0);
+        if (bodyLength < 0 || static_cast<uint64_t>(bodyLength) > size - position) {
+            errorMessage = ERROR_INVALID;
+            return false;
+        }
+
+        const uint8_t* body = bytes + position;
+        position += bodyLength;
+
+        switch (message.Scalar<uint8_t>(MESSAGE_HEADER_TYPE, 0)) {
+            case MESSAGE_HEADER_SCHEMA:
+                if (hasSchema) {
+                    errorMessage = ERROR_INVALID;
+                    return false;
+                }
+
+                errorMessage = ReadSchema(message, columns);
+                if (errorMessage) return false;
+
+                hasSchema = true;
+
+                if (headerRow) {
+                    for (size_t i = 0; i < columns.size(); i++) {
+                        if (!sheet->writeStr(row, col + i, columns[i].name.c_str())) {
+                            return false;
+                        }
+                    }
+                }
+
+                break;
+
+            case MESSAGE_HEADER_RECORD_BATCH: {
+                TableReader batch, compression;
+                size_t nodes, buffers;
+                uint32_t nodeCount, bufferCount, bufferIndex = 0;
+
+                if (!hasSchema ||
+                    !message.Table(MESSAGE_HEADER, batch) ||
+                    !batch.Vector(RECORD_BATCH_NODES, sizeof(FieldNode),
+                        nodes, nodeCount) ||
+                    !batch.Vector(RECORD_BATCH_BUFFERS, sizeof(BufferSpec),
+                        buffers, bufferCount) ||
+                    nodeCount < columns.size())
+                {
+                    errorMessage = ERROR_INVALID;
+                    return false;
+                }
+
+                if (batch.Table(RECORD_BATCH_COMPRESSION, compression)) {
+                    errorMessage = ERROR_COMPRESSION;
+                    return false;
+                }
+
+                int64_t length = batch.Scalar<int64_t>(RECORD_BATCH_LENGTH, 0);
+                if (length < 0 ||
+                    length > std::numeric_limits<int>::max() - nextRow)
+                {
+                    errorMessage = ERROR_INVALID;
+                    return false;
+                }
+
+                for (size_t i = 0; i < columns.size(); i++) {
+                    const ImportColumn& column = columns[i];
+                    FieldNode node;
+                    BufferSpec spec[3];
+                    const uint8_t* buffer[3] = {NULL, NULL, NULL};
+                    uint32_t columnBuffers = column.type == TYPE_NULL ? 0 :
+                        (column.type == TYPE_UTF8 ? 3 : 2);
+
+                    batch.Read(nodes + i * sizeof(FieldNode), node);
+                    if (node.length < 0 || node.length > length ||
+                        bufferCount - bufferIndex < columnBuffers)
+                    {
+                        errorMessage = ERROR_INVALID;
+                        return false;
+                    }
+
+                    for (uint32_t j = 0; j < columnBuffers; j++) {
+                        batch.Read(buffers + bufferIndex++ * sizeof(BufferSpec),
+                            spec[j]);
+
+                        if (spec[j].offset < 0 || spec[j].length < 0 ||
+                            spec[j].offset > bodyLength ||
+                            spec[j].length > bodyLength - spec[j].offset)
+                        {
+                            errorMessage = ERROR_INVALID;
+                            return false;
+                        }
+
+                        buffer[j] = body + spec[j].offset;
+                    }
+
+                    if (column.type == TYPE_NULL) continue;
+
+                    // The validity bitmap may be omitted if there are no nulls
+                    const uint8_t* validity = spec[0].length > 0 ? buffer[0] : NULL;
+
+                    if ((validity && spec[0].length < (node.length + 7) / 8) ||
+                        spec[1].length < DataSize(column, node.length))
+                    {
+                        errorMessage = ERROR_INVALID;
+                        return false;
+                    }
+
+                    libxl::Format* format = NULL;
+                    if (column.type == TYPE_DATE || column.type == TYPE_TIMESTAMP) {
+                        libxl::Format*& cached = column.type == TYPE_DATE ?
+                            dateFormat : timestampFormat;
+
+                        if (!cached) {
+                            cached = book->addFormat();
+                            if (!cached) return false;
+
+                            cached->setNumFormat(column.type == TYPE_DATE ?
+                                libxl::NUMFORMAT_DATE :
+                                libxl::NUMFORMAT_CUSTOM_MDYYYY_HMM);
+                        }
+
+                        format = cached;
+                    }
+
+                    for (int64_t j = 0; j < node.length; j++) {
+                        if (validity && !GetBit(validity, j)) continue;
+
+                        int cellRow = nextRow + j, cellCol = col + i;
+                        bool success;
+
+                        switch (column.type) {
+                            case TYPE_BOOL:
+                                success = sheet->writeBool(cellRow, cellCol,
+                                    GetBit(buffer[1], j));
+                                break;
+
+                            case TYPE_UTF8: {
+                                int32_t start = Load<int32_t>(buffer[1] + j * 4),
+                                    end = Load<int32_t>(buffer[1] + (j + 1) * 4);
+
+                                if (start < 0 || end < start || end > spec[2].length) {
+                                    errorMessage = ERROR_INVALID;
+                                    return false;
+                                }
+
+                                text.assign(reinterpret_cast<const char*>(
+                                    buffer[2] + start), end - start);
+                                success = sheet->writeStr(cellRow, cellCol,
+                                    text.c_str());
+                                break;
+                            }
+
+                            case TYPE_DATE:
+                            case TYPE_TIMESTAMP:
+                                success = sheet->writeNum(cellRow, cellCol,
+                                    NumericValue(column, buffer[1], j) + epochSerial,
+                                    format);
+                                break;
+
+                            default:
+                                success = sheet->writeNum(cellRow, cellCol,
+                                    NumericValue(column, buffer[1], j));
+                                break;
+                        }
+
+                        if (!success) return false;
+                    }
+                }
+
+                nextRow += length;
+                break;
+            }
+
+            case MESSAGE_HEADER_DICTIONARY_BATCH:
+                errorMessage = ERROR_DICTIONARY;
+                return false;
+
+            default:
+                errorMessage = ERROR_INVALID;
+                return false;
+        }
+    }
+
+    if (!hasSchema) {
+        errorMessage = ERROR_INVALID;
+        return false;
+    }
+
+    return true;
+}
+
+
+}
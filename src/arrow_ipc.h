@@ -0,0 +1,89 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 Christian Speckner <cnspeckn@googlemail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef BINDINGS_ARROW_IPC_H
+#define BINDINGS_ARROW_IPC_H
+
+#include <string>
+#include <vector>
+
+#include "common.h"
+
+namespace node_libxl {
+
+
+// Encodes a sheet range as an Apache Arrow IPC stream. Columns are typed as
+// float64, timestamp[ms] (numbers that libxl reports as dates), bool or utf8
+// (strings and columns with mixed content). Bounds may be
+// util::RANGE_DEFAULT. Does not touch V8 and may run on a worker thread.
+class ArrowWriter {
+    public:
+
+        ArrowWriter(int rowFirst, int rowLast, int colFirst, int colLast,
+            bool headerRow);
+
+        bool Write(libxl::Book* book, libxl::Sheet* sheet);
+
+        const std::vector<char>& Stream() const;
+
+    private:
+
+        ArrowWriter(const ArrowWriter&);
+        const ArrowWriter& operator=(const ArrowWriter&);
+
+        int rowFirst, rowLast, colFirst, colLast;
+        bool headerRow;
+
+        std::vector<char> stream;
+};
+
+
+// Writes the record batches of an Apache Arrow IPC stream to a sheet. Does
+// not touch V8 and may run on a worker thread.
+class ArrowReader {
+    public:
+
+        ArrowReader(int row, int col, bool headerRow);
+
+        bool Read(libxl::Book* book, libxl::Sheet* sheet, const char* data,
+            size_t size);
+
+        // NULL if the failure was reported by libxl
+        const char* ErrorMessage() const;
+
+    private:
+
+        ArrowReader(const ArrowReader&);
+        const ArrowReader& operator=(const ArrowReader&);
+
+        int row, col;
+        bool headerRow;
+
+        const char* errorMessage;
+};
+
+
+}
+
+#endif // BINDINGS_ARROW_IPC_H
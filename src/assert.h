@@ -33,6 +33,9 @@
 #define ASSERT_THIS(THIS) if (!THIS) return(Nan::ThrowTypeError("invalid scope")); \
     if (::node_libxl::util::GetBook(THIS)->AsyncPending()) return(Nan::ThrowError("async operation pending"))
 
+// Async methods queue up behind pending operations instead of throwing
+#define ASSERT_THIS_ASYNC(THIS) if (!THIS) return(Nan::ThrowTypeError("invalid scope"))
+
 #define ASSERT_SAME_BOOK(BOOK1, BOOK2) if ( \
     !::node_libxl::util::IsSameBook(BOOK1, BOOK2)) \
     return Nan::ThrowTypeError("parent books differ")
@@ -28,17 +28,54 @@
 #include <v8.h>
 #include <nan.h>
 #include "util.h"
+#include "thread_pool.h"
 
 namespace node_libxl {
 
 
-template<typename T> class AsyncWorker : public Nan::AsyncWorker {
+// Type independent part of AsyncWorker<T> that the queue of a book works on
+class AsyncWorkerBase : public Nan::AsyncWorker {
+    public:
+
+        explicit AsyncWorkerBase(Nan::Callback* callback) :
+            Nan::AsyncWorker(callback),
+            priority(PRIORITY_NORMAL),
+            cancelled(false)
+        {}
+
+        // Thread pool priority, taken from the book when the call is made
+        int GetPriority() const {
+            return priority;
+        }
+
+        bool HasCallback(v8::Local<v8::Function> function) const {
+            return callback && callback->GetFunction() == function;
+        }
+
+        // The callback of a cancelled worker is not called, its results are
+        // dropped with the worker
+        void Cancel() {
+            cancelled = true;
+        }
+
+    protected:
+
+        int priority;
+        bool cancelled;
+};
+
+
+template<typename T> class AsyncWorker : public AsyncWorkerBase {
     public:
 
         AsyncWorker(Nan::Callback* callback, v8::Local<v8::Object> that);
 
         virtual void WorkComplete();
 
+        Book* GetBook() {
+            return util::GetBook(that);
+        }
+
     protected:
 
         void RaiseLibxlError();
@@ -54,10 +91,10 @@ template<typename T> class AsyncWorker : public Nan::AsyncWorker {
 
 template<typename T> AsyncWorker<T>::AsyncWorker(
         Nan::Callback* callback, v8::Local<v8::Object> that) :
-    Nan::AsyncWorker(callback),
+    AsyncWorkerBase(callback),
     that(T::Unwrap(that))
 {
-    util::GetBook(this->that)->StartAsync();
+    priority = GetBook()->GetAsyncPriority();
     SaveToPersistent("that", that);
 }
 
@@ -65,7 +102,7 @@ template<typename T> AsyncWorker<T>::AsyncWorker(
 template<typename T> void AsyncWorker<T>::WorkComplete() {
     util::GetBook(that)->StopAsync();
 
-    Nan::AsyncWorker::WorkComplete();
+    if (!cancelled) Nan::AsyncWorker::WorkComplete();
 }
 
 
@@ -74,6 +111,12 @@ template<typename T> void AsyncWorker<T>::RaiseLibxlError() {
 }
 
 
+// Queues the worker behind the pending async operations of its book
+template<typename T> void AsyncQueueWorker(AsyncWorker<T>* worker) {
+    worker->GetBook()->QueueAsync(worker);
+}
+
+
 }
 
 #endif // BINDINGS_ASYNC_WORKER_H
@@ -0,0 +1,215 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 Christian Speckner <cnspeckn@googlemail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstdio>
+#include <cstring>
+
+#include "batch_loader.h"
+#include "book.h"
+#include "thread_pool.h"
+
+using namespace v8;
+
+namespace node_libxl {
+
+
+namespace {
+
+
+const unsigned char OLE2_SIGNATURE[] = {
+    0xD0, 0xCF, 0x11, 0xE0, 0xA1, 0xB1, 0x1A, 0xE1
+};
+
+const unsigned char ZIP_SIGNATURE[] = {'P', 'K', 0x03, 0x04};
+
+
+// BIFF files are OLE2 compound documents, OOXML files are zip archives
+const char* DetectBookType(const std::string& path, int& type) {
+    unsigned char header[sizeof(OLE2_SIGNATURE)];
+
+    FILE* file = fopen(path.c_str(), "rb");
+
+    if (!file) {
+        return "unable to open file for reading";
+    }
+
+    size_t size = fread(header, 1, sizeof(header), file);
+    fclose(file);
+
+    if (size >= sizeof(OLE2_SIGNATURE) &&
+        memcmp(header, OLE2_SIGNATURE, sizeof(OLE2_SIGNATURE)) == 0)
+    {
+        type = BOOK_TYPE_XLS;
+        return NULL;
+    }
+
+    if (size >= sizeof(ZIP_SIGNATURE) &&
+        memcmp(header, ZIP_SIGNATURE, sizeof(ZIP_SIGNATURE)) == 0)
+    {
+        type = BOOK_TYPE_XLSX;
+        return NULL;
+    }
+
+    return "unknown file format";
+}
+
+
+}
+
+
+// Worker
+
+
+class BatchLoader::Worker : public Nan::AsyncWorker {
+    public:
+
+        Worker(BatchLoader* loader, size_t index) :
+            Nan::AsyncWorker(NULL),
+            loader(loader),
+            index(index),
+            libxlBook(NULL)
+        {}
+
+        ~Worker() {
+            if (libxlBook) libxlBook->release();
+        }
+
+        virtual void Execute() {
+            // An empty batch still completes asynchronously
+            if (index >= loader->paths.size()) return;
+
+            const std::string& path = loader->paths[index];
+            int type;
+
+            const char* error = DetectBookType(path, type);
+            if (error) {
+                return SetErrorMessage(error);
+            }
+
+            libxlBook = Book::NewLibxlBook(type);
+            if (!libxlBook) {
+                return SetErrorMessage("unknown error");
+            }
+
+            if (!libxlBook->load(path.c_str())) {
+                SetErrorMessage(libxlBook->errorMessage());
+            }
+        }
+
+        virtual void HandleOKCallback() {
+            Nan::HandleScope scope;
+
+            Local<Value> book = Nan::Undefined();
+
+            if (libxlBook) {
+                book = Book::NewInstance(libxlBook);
+                libxlBook = NULL;
+            }
+
+            loader->Complete(index, Nan::Undefined(), book);
+        }
+
+        virtual void HandleErrorCallback() {
+            Nan::HandleScope scope;
+
+            loader->Complete(index, Nan::Error(ErrorMessage()),
+                Nan::Undefined());
+        }
+
+    private:
+
+        BatchLoader* loader;
+        size_t index;
+        libxl::Book* libxlBook;
+};
+
+
+// Lifecycle
+
+
+BatchLoader::BatchLoader(
+    const std::vector<std::string>& paths,
+    unsigned concurrency,
+    int priority,
+    Local<Function> onBook,
+    Local<Function> callback
+) :
+    paths(paths),
+    next(0),
+    running(0),
+    concurrency(concurrency),
+    priority(priority),
+    onBook(onBook),
+    callback(callback)
+{}
+
+
+// Dispatch
+
+
+void BatchLoader::Start() {
+    if (paths.empty()) {
+        running++;
+        ThreadPool::Queue(new Worker(this, 0), priority);
+        return;
+    }
+
+    Dispatch();
+}
+
+
+void BatchLoader::Dispatch() {
+    while (running < concurrency && next < paths.size()) {
+        running++;
+        ThreadPool::Queue(new Worker(this, next++), priority);
+    }
+}
+
+
+void BatchLoader::Complete(size_t index, Local<Value> error,
+    Local<Value> book)
+{
+    Nan::HandleScope scope;
+
+    running--;
+
+    // Refill the pool before handing out the book, the callback may take a
+    // while
+    Dispatch();
+
+    if (index < paths.size()) {
+        Local<Value> argv[] = {
+            error, book, Nan::New<Number>(static_cast<double>(index))
+        };
+        onBook.Call(3, argv);
+    }
+
+    if (running == 0 && next == paths.size()) {
+        callback.Call(0, NULL);
+        delete this;
+    }
+}
+
+
+}
@@ -0,0 +1,79 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 Christian Speckner <cnspeckn@googlemail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef BINDINGS_BATCH_LOADER_H
+#define BINDINGS_BATCH_LOADER_H
+
+#include <string>
+#include <vector>
+
+#include "common.h"
+
+namespace node_libxl {
+
+
+// Loads a list of files into new books for Book.loadMany. The type of each
+// book is detected from the signature of its file. At most `concurrency`
+// files are queued on the thread pool at any time, every finished load queues
+// the next file, so a long list never floods the pool. onBook(err, book,
+// index) is called for each file as it completes, callback() once after the
+// last one. The loader deletes itself after the final callback.
+class BatchLoader {
+    public:
+
+        BatchLoader(
+            const std::vector<std::string>& paths,
+            unsigned concurrency,
+            int priority,
+            v8::Local<v8::Function> onBook,
+            v8::Local<v8::Function> callback
+        );
+
+        void Start();
+
+    private:
+
+        class Worker;
+
+        BatchLoader(const BatchLoader&);
+        const BatchLoader& operator=(const BatchLoader&);
+
+        ~BatchLoader() {}
+
+        void Dispatch();
+        void Complete(size_t index, v8::Local<v8::Value> error,
+            v8::Local<v8::Value> book);
+
+        std::vector<std::string> paths;
+        size_t next, running;
+        unsigned concurrency;
+        int priority;
+
+        Nan::Callback onBook, callback;
+};
+
+
+}
+
+#endif // BINDINGS_BATCH_LOADER_H
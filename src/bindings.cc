@@ -27,6 +27,8 @@
 #include "sheet.h"
 #include "format.h"
 #include "font.h"
+#include "string_pool.h"
+#include "thread_pool.h"
 
 using namespace v8;
 using namespace node_libxl;
@@ -36,6 +38,8 @@ void Initialize(Handle<Object> exports) {
     Sheet::Initialize(exports);
     Format::Initialize(exports);
     Font::Initialize(exports);
+    StringPool::Initialize(exports);
+    ThreadPool::Initialize(exports);
 }
 
 NODE_MODULE(libxl, Initialize)
@@ -34,19 +34,57 @@
 #include "api_key.h"
 #include "async_worker.h"
 #include "string_copy.h"
+#include "utf8_string.h"
 #include "buffer_copy.h"
+#include "object_shape.h"
+#include "thread_pool.h"
+#include "batch_loader.h"
 
 using namespace v8;
 
 namespace node_libxl {
 
 
+// Result shapes
+
+
+namespace {
+
+
+const char* const DATE_UNPACK_KEYS[] = {
+    "year", "month", "day", "hour", "minute", "second", "msecond", NULL
+};
+ObjectShape dateUnpackShape(DATE_UNPACK_KEYS);
+
+
+const char* const COLOR_UNPACK_KEYS[] = {
+    "red", "green", "blue", NULL
+};
+ObjectShape colorUnpackShape(COLOR_UNPACK_KEYS);
+
+
+const char* const GET_PICTURE_KEYS[] = {
+    "type", "data", NULL
+};
+ObjectShape getPictureShape(GET_PICTURE_KEYS);
+
+
+const char* const DEFAULT_FONT_KEYS[] = {
+    "name", "size", NULL
+};
+ObjectShape defaultFontShape(DEFAULT_FONT_KEYS);
+
+
+}
+
+
 // Lifecycle
 
 
 Book::Book(libxl::Book* libxlBook) :
     Wrapper<libxl::Book>(libxlBook),
-    asyncPending(false)
+    runningWorker(NULL),
+    asyncPriority(PRIORITY_NORMAL)
 {}
 
 
@@ -55,19 +93,7 @@ Book::~Book() {
 }
 
 
-NAN_METHOD(Book::New) {
-    Nan::HandleScope scope;
-
-    if (!info.IsConstructCall()) {
-        info.GetReturnValue().Set(
-            util::ProxyConstructor(Nan::New(constructor), info));
-    }
-
-    ArgumentHelper arguments(info);
-
-    int type = arguments.GetInt(0);
-    ASSERT_ARGUMENTS(arguments);
-
+libxl::Book* Book::NewLibxlBook(int type) {
     libxl::Book* libxlBook;
 
     switch (type) {
@@ -78,11 +104,11 @@ NAN_METHOD(Book::New) {
             libxlBook = xlCreateXMLBook();
             break;
         default:
-            return Nan::ThrowTypeError("invalid book type");
+            return NULL;
     }
 
     if (!libxlBook) {
-        return Nan::ThrowError("unknown error");
+        return NULL;
     }
 
     libxlBook->setLocale("UTF-8");
@@ -90,6 +116,51 @@ NAN_METHOD(Book::New) {
         libxlBook->setKey(API_KEY_NAME, API_KEY_KEY);
     #endif
 
+    return libxlBook;
+}
+
+
+Local<Object> Book::NewInstance(libxl::Book* libxlBook) {
+    Nan::EscapableHandleScope scope;
+
+    Handle<Value> argv[1] = {CSNanNewExternal(libxlBook)};
+
+    return scope.Escape(Nan::New(constructor)->NewInstance(1, argv));
+}
+
+
+NAN_METHOD(Book::New) {
+    Nan::HandleScope scope;
+
+    if (!info.IsConstructCall()) {
+        info.GetReturnValue().Set(
+            util::ProxyConstructor(Nan::New(constructor), info));
+    }
+
+    libxl::Book* libxlBook;
+
+    // Books created natively (see NewInstance) arrive as an external, which
+    // cannot be constructed from JS
+    if (info.Length() == 1 && info[0]->IsExternal()) {
+        libxlBook = static_cast<libxl::Book*>(
+            info[0].As<External>()->Value());
+    } else {
+        ArgumentHelper arguments(info);
+
+        int type = arguments.GetInt(0);
+        ASSERT_ARGUMENTS(arguments);
+
+        if (type != BOOK_TYPE_XLS && type != BOOK_TYPE_XLSX) {
+            return Nan::ThrowTypeError("invalid book type");
+        }
+
+        libxlBook = NewLibxlBook(type);
+    }
+
+    if (!libxlBook) {
+        return Nan::ThrowError("unknown error");
+    }
+
     Book* book = new Book(libxlBook);
     book->Wrap(info.This());
 
@@ -97,38 +168,120 @@ NAN_METHOD(Book::New) {
 }
 
 
-// Async guard
+// Async queue
 
 
-void Book::StartAsync() {
-    asyncPending = true;
+void Book::QueueAsync(AsyncWorkerBase* worker) {
+    if (runningWorker) {
+        asyncQueue.push_back(worker);
+        return;
+    }
+
+    runningWorker = worker;
+    ThreadPool::Queue(worker, worker->GetPriority());
 }
 
 
 void Book::StopAsync() {
-    asyncPending = false;
+    runningWorker = NULL;
+    if (asyncQueue.empty()) return;
+
+    runningWorker = asyncQueue.front();
+    asyncQueue.pop_front();
+
+    ThreadPool::Queue(runningWorker, runningWorker->GetPriority());
 }
 
 
-bool Book::AsyncPending() {
-    return asyncPending;
+bool Book::CancelAsync(Local<Function> callback) {
+    if (runningWorker && runningWorker->HasCallback(callback)) {
+        runningWorker->Cancel();
+        return true;
+    }
+
+    for (std::deque<AsyncWorkerBase*>::iterator it = asyncQueue.begin();
+        it != asyncQueue.end(); ++it)
+    {
+        if ((*it)->HasCallback(callback)) {
+            delete *it;
+            asyncQueue.erase(it);
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+void Book::ClearWrapperCaches() {
+    sheetCache.Clear();
+    formatCache.Clear();
+    fontCache.Clear();
 }
 
 
 // Implementation
 
 
+NAN_METHOD(Book::LoadMany) {
+    Nan::HandleScope scope;
+
+    ArgumentHelper arguments(info);
+
+    // The options argument may be omitted
+    uint8_t onBookPos = info[1]->IsFunction() ? 1 : 2;
+
+    Local<Array> pathHandles = arguments.GetArray(0);
+    int concurrency = ThreadPool::Size(),
+        priority = PRIORITY_NORMAL;
+    if (onBookPos == 2) {
+        concurrency = arguments.GetIntOption(1, "concurrency", concurrency);
+        priority    = arguments.GetIntOption(1, "priority", priority);
+    }
+    Local<Function> onBook = arguments.GetFunction(onBookPos);
+    Local<Function> callback = arguments.GetFunction(onBookPos + 1);
+    ASSERT_ARGUMENTS(arguments);
+
+    if (concurrency < 1) {
+        return Nan::ThrowRangeError("invalid concurrency");
+    }
+
+    if (priority < 0 || priority >= PRIORITY_COUNT) {
+        return Nan::ThrowRangeError("invalid priority");
+    }
+
+    std::vector<std::string> paths;
+    paths.reserve(pathHandles->Length());
+
+    for (uint32_t i = 0; i < pathHandles->Length(); i++) {
+        Local<Value> path = pathHandles->Get(i);
+
+        if (!path->IsString()) {
+            return Nan::ThrowTypeError("array of file names required");
+        }
+
+        Utf8String pathChars(path);
+        paths.push_back(std::string(*pathChars, pathChars.length()));
+    }
+
+    (new BatchLoader(paths, concurrency, priority, onBook, callback))->Start();
+}
+
+
 NAN_METHOD(Book::LoadSync){
     Nan::HandleScope scope;
 
     ArgumentHelper arguments(info);
 
-    String::Utf8Value filename(arguments.GetString(0));
+    Utf8String filename(arguments.GetString(0));
     ASSERT_ARGUMENTS(arguments);
 
     Book* that = Unwrap(info.This());
     ASSERT_THIS(that);
 
+    that->ClearWrapperCaches();
+
     if (!that->GetWrapped()->load(*filename)) {
         return util::ThrowLibxlError(that);
     }
@@ -151,6 +304,15 @@ NAN_METHOD(Book::Load) {
                 }
             }
 
+            // Operations queued before the load may have filled the wrapper
+            // caches, so they are cleared once the load has taken effect.
+            // This also runs for cancelled loads.
+            virtual void WorkComplete() {
+                if (!ErrorMessage()) that->ClearWrapperCaches();
+
+                AsyncWorker<Book>::WorkComplete();
+            }
+
         private:
             StringCopy filename;
     };
@@ -164,9 +326,9 @@ NAN_METHOD(Book::Load) {
     ASSERT_ARGUMENTS(arguments);
 
     Book* that = Unwrap(info.This());
-    ASSERT_THIS(that);
+    ASSERT_THIS_ASYNC(that);
 
-    Nan::AsyncQueueWorker(new Worker(new Nan::Callback(callback), info.This(), filename));
+    AsyncQueueWorker(new Worker(new Nan::Callback(callback), info.This(), filename));
 
     info.GetReturnValue().Set(info.This());
 }
@@ -177,7 +339,7 @@ NAN_METHOD(Book::WriteSync) {
 
     ArgumentHelper arguments(info);
 
-    String::Utf8Value filename(arguments.GetString(0));
+    Utf8String filename(arguments.GetString(0));
     ASSERT_ARGUMENTS(arguments);
 
     Book* that = Unwrap(info.This());
@@ -219,9 +381,9 @@ NAN_METHOD(Book::Write) {
     ASSERT_ARGUMENTS(arguments);
 
     Book* that = Unwrap(info.This());
-    ASSERT_THIS(that);
+    ASSERT_THIS_ASYNC(that);
 
-    Nan::AsyncQueueWorker(new Worker(new Nan::Callback(callback), info.This(), filename));
+    AsyncQueueWorker(new Worker(new Nan::Callback(callback), info.This(), filename));
 
     info.GetReturnValue().Set(info.This());
 }
@@ -251,9 +413,15 @@ NAN_METHOD(Book::WriteRaw) {
     class Worker : public AsyncWorker<Book> {
         public:
             Worker(Nan::Callback *callback, Local<Object> that) :
-                AsyncWorker<Book>(callback, that)
+                AsyncWorker<Book>(callback, that),
+                buffer(NULL)
             {}
 
+            // Frees the data if the result is dropped
+            virtual ~Worker() {
+                delete[] buffer;
+            }
+
             virtual void Execute() {
                 const char* data;
 
@@ -272,6 +440,8 @@ NAN_METHOD(Book::WriteRaw) {
                     Nan::Undefined(),
                     Nan::NewBuffer(buffer, size).ToLocalChecked()
                 };
+                buffer = NULL;
+
                 callback->Call(2, argv);
             }
 
@@ -288,9 +458,9 @@ NAN_METHOD(Book::WriteRaw) {
     ASSERT_ARGUMENTS(arguments);
 
     Book* that = Unwrap(info.This());
-    ASSERT_THIS(that);
+    ASSERT_THIS_ASYNC(that);
 
-    Nan::AsyncQueueWorker(new Worker(new Nan::Callback(callback), info.This()));
+    AsyncQueueWorker(new Worker(new Nan::Callback(callback), info.This()));
 
     info.GetReturnValue().Set(info.This());
 }
@@ -307,6 +477,8 @@ NAN_METHOD(Book::LoadRawSync) {
     Book* that = Unwrap(info.This());
     ASSERT_THIS(that);
 
+    that->ClearWrapperCaches();
+
     if (!that->GetWrapped()->loadRaw(
         node::Buffer::Data(buffer), node::Buffer::Length(buffer)))
     {
@@ -332,6 +504,15 @@ NAN_METHOD(Book::LoadRaw) {
                 }
             }
 
+            // Operations queued before the load may have filled the wrapper
+            // caches, so they are cleared once the load has taken effect.
+            // This also runs for cancelled loads.
+            virtual void WorkComplete() {
+                if (!ErrorMessage()) that->ClearWrapperCaches();
+
+                AsyncWorker<Book>::WorkComplete();
+            }
+
         private:
             BufferCopy buffer;
     };
@@ -345,9 +526,9 @@ NAN_METHOD(Book::LoadRaw) {
     ASSERT_ARGUMENTS(arguments);
 
     Book* that = Unwrap(info.This());
-    ASSERT_THIS(that);
+    ASSERT_THIS_ASYNC(that);
 
-    Nan::AsyncQueueWorker(new Worker(
+    AsyncQueueWorker(new Worker(
         new Nan::Callback(callback), info.This(), buffer));
 
     info.GetReturnValue().Set(info.This());
@@ -359,7 +540,7 @@ NAN_METHOD(Book::AddSheet) {
 
     ArgumentHelper arguments(info);
 
-    String::Utf8Value name(arguments.GetString(0));
+    Utf8String name(arguments.GetString(0));
     Sheet* parentSheet = arguments.GetWrapped<Sheet>(1, NULL);
     ASSERT_ARGUMENTS(arguments);
 
@@ -389,7 +570,7 @@ NAN_METHOD(Book::InsertSheet) {
     ArgumentHelper arguments(info);
 
     int index = arguments.GetInt(0);
-    String::Utf8Value name(arguments.GetString(1));
+    Utf8String name(arguments.GetString(1));
     Sheet* parentSheet = arguments.GetWrapped<Sheet>(2, NULL);
     ASSERT_ARGUMENTS(arguments);
 
@@ -457,10 +638,17 @@ NAN_METHOD(Book::DelSheet) {
     Book* that = Unwrap(info.This());
     ASSERT_THIS(that);
 
+    // The sheet is freed, and libxl may hand out its address again
+    libxl::Sheet* sheet = that->GetWrapped()->getSheet(index);
+
     if (!that->GetWrapped()->delSheet(index)) {
         return util::ThrowLibxlError(that);
     }
 
+    if (sheet) {
+        that->GetSheetCache().Remove(sheet);
+    }
+
     info.GetReturnValue().Set(info.This());
 }
 
@@ -538,7 +726,7 @@ NAN_METHOD(Book::AddCustomNumFormat) {
 
     ArgumentHelper arguments(info);
 
-    String::Utf8Value description(arguments.GetString(0));
+    Utf8String description(arguments.GetString(0));
     ASSERT_ARGUMENTS(arguments);
 
     Book* that = Unwrap(info.This());
@@ -674,14 +862,16 @@ NAN_METHOD(Book::DateUnpack) {
         return util::ThrowLibxlError(that);
     }
 
-    Local<Object> result = Nan::New<Object>();
-    result->Set(Nan::New<String>("year").ToLocalChecked(),      Nan::New<Integer>(year));
-    result->Set(Nan::New<String>("month").ToLocalChecked(),     Nan::New<Integer>(month));
-    result->Set(Nan::New<String>("day").ToLocalChecked(),       Nan::New<Integer>(day));
-    result->Set(Nan::New<String>("hour").ToLocalChecked(),      Nan::New<Integer>(hour));
-    result->Set(Nan::New<String>("minute").ToLocalChecked(),    Nan::New<Integer>(minute));
-    result->Set(Nan::New<String>("second").ToLocalChecked(),    Nan::New<Integer>(second));
-    result->Set(Nan::New<String>("msecond").ToLocalChecked(),   Nan::New<Integer>(msecond));
+    Local<Value> values[] = {
+        Nan::New<Integer>(year),
+        Nan::New<Integer>(month),
+        Nan::New<Integer>(day),
+        Nan::New<Integer>(hour),
+        Nan::New<Integer>(minute),
+        Nan::New<Integer>(second),
+        Nan::New<Integer>(msecond)
+    };
+    Local<Object> result = dateUnpackShape.NewInstance(values);
 
     info.GetReturnValue().Set(result);
 }
@@ -715,15 +905,17 @@ NAN_METHOD(Book::ColorUnpack) {
     Book* that = Unwrap(info.This());
     ASSERT_THIS(that);
 
-    Local<Object> result = Nan::New<Object>();
     int red, green, blue;
 
     that->GetWrapped()->colorUnpack(
         static_cast<libxl::Color>(value), &red, &green, &blue);
 
-    result->Set(Nan::New<String>("red").ToLocalChecked(),   Nan::New<Integer>(red));
-    result->Set(Nan::New<String>("green").ToLocalChecked(), Nan::New<Integer>(green));
-    result->Set(Nan::New<String>("blue").ToLocalChecked(),  Nan::New<Integer>(blue));
+    Local<Value> values[] = {
+        Nan::New<Integer>(red),
+        Nan::New<Integer>(green),
+        Nan::New<Integer>(blue)
+    };
+    Local<Object> result = colorUnpackShape.NewInstance(values);
 
     info.GetReturnValue().Set(result);
 }
@@ -789,9 +981,11 @@ NAN_METHOD(Book::GetPicture) {
     char* buffer = new char[size];
     memcpy(buffer, data, size);
 
-    Local<Object> result = Nan::New<Object>();
-    result->Set(Nan::New<String>("type").ToLocalChecked(), Nan::New<Integer>(pictureType));
-    result->Set(Nan::New<String>("data").ToLocalChecked(), Nan::NewBuffer(buffer, size).ToLocalChecked());
+    Local<Value> values[] = {
+        Nan::New<Integer>(pictureType),
+        Nan::NewBuffer(buffer, size).ToLocalChecked()
+    };
+    Local<Object> result = getPictureShape.NewInstance(values);
 
     info.GetReturnValue().Set(result);
 }
@@ -802,9 +996,15 @@ NAN_METHOD(Book::GetPictureAsync) {
         public:
             Worker(Nan::Callback* callback, Local<Object> that, int index) :
                 AsyncWorker<Book>(callback, that),
-                index(index)
+                index(index),
+                buffer(NULL)
             {}
 
+            // Frees the data if the result is dropped
+            virtual ~Worker() {
+                delete[] buffer;
+            }
+
             virtual void Execute() {
                 const char* data;
 
@@ -825,6 +1025,7 @@ NAN_METHOD(Book::GetPictureAsync) {
                     Nan::New<Integer>(pictureType),
                     Nan::NewBuffer(buffer, size).ToLocalChecked()
                 };
+                buffer = NULL;
 
                 callback->Call(3, argv);
             }
@@ -844,9 +1045,9 @@ NAN_METHOD(Book::GetPictureAsync) {
     ASSERT_ARGUMENTS(arguments);
 
     Book* that = Unwrap(info.This());
-    ASSERT_THIS(that);
+    ASSERT_THIS_ASYNC(that);
 
-    Nan::AsyncQueueWorker(new Worker(new Nan::Callback(callback), info.This(), index));
+    AsyncQueueWorker(new Worker(new Nan::Callback(callback), info.This(), index));
 
     info.GetReturnValue().Set(info.This());
 }
@@ -864,7 +1065,7 @@ NAN_METHOD(Book::AddPicture) {
 
     if (info[0]->IsString()) {
 
-        String::Utf8Value filename(arguments.GetString(0));
+        Utf8String filename(arguments.GetString(0));
         ASSERT_ARGUMENTS(arguments);
 
         index = that->GetWrapped()->addPicture(*filename);
@@ -958,14 +1159,14 @@ NAN_METHOD(Book::AddPictureAsync) {
     Local<Function> callback = arguments.GetFunction(1);
 
     Book* that = Unwrap(info.This());
-    ASSERT_THIS(that);
+    ASSERT_THIS_ASYNC(that);
 
     if (info[0]->IsString()) {
 
         Handle<Value> filename = arguments.GetString(0);
         ASSERT_ARGUMENTS(arguments);
 
-        Nan::AsyncQueueWorker(new FileWorker(
+        AsyncQueueWorker(new FileWorker(
             new Nan::Callback(callback), info.This(), filename));
 
     } else if (node::Buffer::HasInstance(info[0])) {
@@ -973,7 +1174,7 @@ NAN_METHOD(Book::AddPictureAsync) {
         Handle<Value> buffer = arguments.GetBuffer(0);
         ASSERT_ARGUMENTS(arguments);
 
-        Nan::AsyncQueueWorker(new BufferWorker(
+        AsyncQueueWorker(new BufferWorker(
             new Nan::Callback(callback), info.This(), buffer));
 
     } else {
@@ -997,9 +1198,11 @@ NAN_METHOD(Book::DefaultFont) {
         return util::ThrowLibxlError(that);
     }
 
-    Local<Object> result = Nan::New<Object>();
-    result->Set(Nan::New<String>("name").ToLocalChecked(), Nan::New<String>(name).ToLocalChecked());
-    result->Set(Nan::New<String>("size").ToLocalChecked(), Nan::New<Integer>(size));
+    Local<Value> values[] = {
+        Nan::New<String>(name).ToLocalChecked(),
+        Nan::New<Integer>(size)
+    };
+    Local<Object> result = defaultFontShape.NewInstance(values);
 
     info.GetReturnValue().Set(result);
 }
@@ -1010,7 +1213,7 @@ NAN_METHOD(Book::SetDefaultFont) {
 
     ArgumentHelper arguments(info);
 
-    String::Utf8Value name(arguments.GetString(0));
+    Utf8String name(arguments.GetString(0));
     int size = arguments.GetInt(1);
     ASSERT_ARGUMENTS(arguments);
 
@@ -1145,7 +1348,7 @@ NAN_METHOD(Book::SetKey) {
 
     ArgumentHelper arguments(info);
 
-    String::Utf8Value   name(arguments.GetString(0)),
+    Utf8String   name(arguments.GetString(0)),
                         key(arguments.GetString(1));
     ASSERT_ARGUMENTS(arguments);
 
@@ -1158,6 +1361,52 @@ NAN_METHOD(Book::SetKey) {
 }
 
 
+NAN_METHOD(Book::CancelAsync) {
+    Nan::HandleScope scope;
+
+    ArgumentHelper arguments(info);
+
+    Local<Function> callback = arguments.GetFunction(0);
+    ASSERT_ARGUMENTS(arguments);
+
+    Book* that = Unwrap(info.This());
+    ASSERT_THIS_ASYNC(that);
+
+    info.GetReturnValue().Set(Nan::New<Boolean>(that->CancelAsync(callback)));
+}
+
+
+NAN_METHOD(Book::SetAsyncPriority) {
+    Nan::HandleScope scope;
+
+    ArgumentHelper arguments(info);
+
+    int priority = arguments.GetInt(0);
+    ASSERT_ARGUMENTS(arguments);
+
+    if (priority < 0 || priority >= PRIORITY_COUNT) {
+        return Nan::ThrowRangeError("invalid priority");
+    }
+
+    Book* that = Unwrap(info.This());
+    ASSERT_THIS_ASYNC(that);
+
+    that->SetAsyncPriority(priority);
+
+    info.GetReturnValue().Set(info.This());
+}
+
+
+NAN_METHOD(Book::AsyncPriority) {
+    Nan::HandleScope scope;
+
+    Book* that = Unwrap(info.This());
+    ASSERT_THIS_ASYNC(that);
+
+    info.GetReturnValue().Set(Nan::New<Integer>(that->GetAsyncPriority()));
+}
+
+
 // Init
 
 
@@ -1170,6 +1419,8 @@ void Book::Initialize(Handle<Object> exports) {
     t->SetClassName(Nan::New<String>("Book").ToLocalChecked());
     t->InstanceTemplate()->SetInternalFieldCount(1);
 
+    Nan::SetMethod(t, "loadMany", LoadMany);
+
     Nan::SetPrototypeMethod(t, "loadSync", LoadSync);
     Nan::SetPrototypeMethod(t, "load", Load);
     Nan::SetPrototypeMethod(t, "writeSync", WriteSync);
@@ -1219,6 +1470,9 @@ void Book::Initialize(Handle<Object> exports) {
     Nan::SetPrototypeMethod(t, "isTemplate", IsTemplate);
     Nan::SetPrototypeMethod(t, "setTemplate", SetTemplate);
     Nan::SetPrototypeMethod(t, "setKey", SetKey);
+    Nan::SetPrototypeMethod(t, "cancelAsync", CancelAsync);
+    Nan::SetPrototypeMethod(t, "setAsyncPriority", SetAsyncPriority);
+    Nan::SetPrototypeMethod(t, "asyncPriority", AsyncPriority);
 
     #ifdef INCLUDE_API_KEY
         CSNanObjectSetWithAttributes(exports, Nan::New<String>("apiKeyCompiledIn").ToLocalChecked(), Nan::True(),
@@ -1229,6 +1483,7 @@ void Book::Initialize(Handle<Object> exports) {
     #endif
 
     t->ReadOnlyPrototype();
+    constructorTemplate.Reset(t);
     constructor.Reset(t->GetFunction());
     exports->Set(Nan::New<String>("Book").ToLocalChecked(), Nan::New(constructor));
 
@@ -25,12 +25,21 @@
 #ifndef BINDINGS_BOOK
 #define BINDINGS_BOOK
 
+#include <deque>
+
 #include "common.h"
 #include "wrapper.h"
+#include "wrapper_cache.h"
 
 namespace node_libxl {
 
 
+class Format;
+class Font;
+class Sheet;
+class AsyncWorkerBase;
+
+
 enum {
     BOOK_TYPE_XLS,
     BOOK_TYPE_XLSX
@@ -43,9 +52,52 @@ class Book : public Wrapper<libxl::Book> {
         Book(libxl::Book* libxlBook);
         ~Book();
 
-        void StartAsync();
+        // Async operations run one at a time in FIFO order. Each finished
+        // operation dispatches the next one before its callback is called,
+        // sync calls are rejected as long as any operation is queued.
+        void QueueAsync(AsyncWorkerBase* worker);
         void StopAsync();
-        bool AsyncPending();
+        bool AsyncPending() {
+            return runningWorker != NULL;
+        }
+
+        // Thread pool priority of subsequent async calls on the book and its
+        // sheets
+        int GetAsyncPriority() const {
+            return asyncPriority;
+        }
+
+        void SetAsyncPriority(int priority) {
+            asyncPriority = priority;
+        }
+
+        // Removes a queued operation or drops the result of the running one.
+        // Returns false if no operation with this callback is pending.
+        bool CancelAsync(v8::Local<v8::Function> callback);
+
+        // Identity caches for the wrappers of this book's sheets, formats and
+        // fonts
+        WrapperCache<libxl::Sheet, node_libxl::Sheet>& GetSheetCache() {
+            return sheetCache;
+        }
+
+        WrapperCache<libxl::Format, node_libxl::Format>& GetFormatCache() {
+            return formatCache;
+        }
+
+        WrapperCache<libxl::Font, node_libxl::Font>& GetFontCache() {
+            return fontCache;
+        }
+
+        // Loading replaces the sheets, formats and fonts of the book
+        void ClearWrapperCaches();
+
+        // Creates a libxl book with locale and API key set up, NULL if the
+        // type is invalid. Safe to call off the main thread.
+        static libxl::Book* NewLibxlBook(int type);
+
+        // Wraps a book created by NewLibxlBook, taking ownership
+        static v8::Local<v8::Object> NewInstance(libxl::Book* libxlBook);
 
         static void Initialize(v8::Handle<v8::Object> exports);
 
@@ -56,6 +108,7 @@ class Book : public Wrapper<libxl::Book> {
     protected:
 
         static NAN_METHOD(New);
+        static NAN_METHOD(LoadMany);
 
         static NAN_METHOD(LoadSync);
         static NAN_METHOD(Load);
@@ -102,13 +155,22 @@ class Book : public Wrapper<libxl::Book> {
         static NAN_METHOD(IsTemplate);
         static NAN_METHOD(SetTemplate);
         static NAN_METHOD(SetKey);
+        static NAN_METHOD(CancelAsync);
+        static NAN_METHOD(SetAsyncPriority);
+        static NAN_METHOD(AsyncPriority);
 
     private:
 
         Book(const Book&);
         const Book& operator=(const Book&);
 
-        bool asyncPending;
+        AsyncWorkerBase* runningWorker;
+        int asyncPriority;
+        std::deque<AsyncWorkerBase*> asyncQueue;
+
+        WrapperCache<libxl::Sheet, node_libxl::Sheet> sheetCache;
+        WrapperCache<libxl::Format, node_libxl::Format> formatCache;
+        WrapperCache<libxl::Font, node_libxl::Font> fontCache;
 };
 
 
@@ -29,7 +29,8 @@ using namespace v8;
 namespace node_libxl {
 
 
-BookWrapper::BookWrapper(Local<Value> bookHandle)
+BookWrapper::BookWrapper(Local<Value> bookHandle) :
+    book(Book::Unwrap(bookHandle))
 {
     this->bookHandle.Reset(bookHandle);
 }
@@ -47,11 +48,4 @@ v8::Local<v8::Value> BookWrapper::GetBookHandle() {
 }
 
 
-Book* BookWrapper::GetBook() {
-    Nan::HandleScope scope;
-
-    return Book::Unwrap(Nan::New(bookHandle));
-}
-
-
 }
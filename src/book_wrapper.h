@@ -38,10 +38,17 @@ class BookWrapper{
         ~BookWrapper();
 
         v8::Local<v8::Value> GetBookHandle();
-        Book* GetBook();
+
+        // The persistent handle keeps the book alive for the lifetime of the
+        // wrapper, so the native pointer can be resolved once and cached.
+        Book* GetBook() {
+            return book;
+        }
+
     protected:
 
         Nan::Persistent<v8::Value> bookHandle;
+        Book* book;
 
         // We need to template this in order to unwrap the correct object
         // pointer
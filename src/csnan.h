@@ -48,4 +48,27 @@
 
 #endif
 
+#if (NODE_MODULE_VERSION > 0x000B)
+
+#define CSNanIsFloat64Array(Value) (Value)->IsFloat64Array()
+
+#else
+
+#define CSNanIsFloat64Array(Value) ((Value)->IsObject() && \
+    (Value).As<v8::Object>()->GetIndexedPropertiesExternalArrayDataType() == \
+        v8::kExternalDoubleArray)
+
+#endif
+
+#if (NODE_MODULE_VERSION > 0x000B)
+
+#define CSNanNewInternalizedString(Value) v8::String::NewFromUtf8( \
+    v8::Isolate::GetCurrent(), Value, v8::String::kInternalizedString)
+
+#else
+
+#define CSNanNewInternalizedString(Value) v8::String::NewSymbol(Value)
+
+#endif
+
 #endif //BINDINGS_CSNAN_H
@@ -0,0 +1,596 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 Christian Speckner <cnspeckn@googlemail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "csv.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#include "util.h"
+
+namespace node_libxl {
+
+
+namespace {
+
+
+// Output is collected in memory and handed to the file in blocks of this
+// size
+const size_t FLUSH_SIZE = 1 << 20;
+
+const char* const ERROR_OPEN_WRITE = "unable to open file for writing";
+const char* const ERROR_WRITE = "error writing file";
+const char* const ERROR_OPEN_READ = "unable to open file for reading";
+const char* const ERROR_READ = "error reading file";
+
+
+size_t FormatDate(libxl::Book* book, double value, char* buffer) {
+    int year, month, day, hour, minute, second, msecond;
+
+    if (!book->dateUnpack(value, &year, &month, &day, &hour, &minute, &second,
+        &msecond))
+    {
+        return util::FormatNumber(value, buffer);
+    }
+
+    if (hour == 0 && minute == 0 && second == 0 && msecond == 0) {
+        return sprintf(buffer, "%04d-%02d-%02d", year, month, day);
+    }
+
+    if (msecond == 0) {
+        return sprintf(buffer, "%04d-%02d-%02dT%02d:%02d:%02d",
+            year, month, day, hour, minute, second);
+    }
+
+    return sprintf(buffer, "%04d-%02d-%02dT%02d:%02d:%02d.%03d",
+        year, month, day, hour, minute, second, msecond);
+}
+
+
+bool IsDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+
+// Accepts decimal numbers with optional sign, fraction and exponent. Unlike
+// plain strtod, this rejects hex numbers, inf / nan and surrounding space.
+// Integer parts with leading zeros (zip codes, IDs) are left to be strings.
+bool ParseNumber(const char* value, size_t length, double& number) {
+    size_t i = 0, digits = 0;
+
+    if (value[i] == '-' || value[i] == '+') i++;
+    if (length - i > 1 && value[i] == '0' && IsDigit(value[i + 1])) {
+        return false;
+    }
+
+    for (; i < length && IsDigit(value[i]); i++) digits++;
+
+    if (i < length && value[i] == '.') {
+        for (i++; i < length && IsDigit(value[i]); i++) digits++;
+    }
+
+    if (digits == 0) return false;
+
+    if (i < length && (value[i] == 'e' || value[i] == 'E')) {
+        size_t exponentDigits = 0;
+
+        i++;
+        if (i < length && (value[i] == '-' || value[i] == '+')) i++;
+        for (; i < length && IsDigit(value[i]); i++) exponentDigits++;
+
+        if (exponentDigits == 0) return false;
+    }
+
+    if (i != length) return false;
+
+    number = strtod(value, NULL);
+    return true;
+}
+
+
+bool EqualsIgnoreCase(const char* value, size_t length, const char* lower) {
+    size_t i = 0;
+
+    for (; i < length && lower[i]; i++) {
+        char c = value[i];
+        if (c >= 'A' && c <= 'Z') c += 'a' - 'A';
+        if (c != lower[i]) return false;
+    }
+
+    return i == length && !lower[i];
+}
+
+
+bool ParseBoolean(const char* value, size_t length, bool& boolean) {
+    if (EqualsIgnoreCase(value, length, "true")) {
+        boolean = true;
+        return true;
+    }
+
+    if (EqualsIgnoreCase(value, length, "false")) {
+        boolean = false;
+        return true;
+    }
+
+    return false;
+}
+
+
+bool ParseDigits(const char*& p, const char* end, int count, int& value) {
+    if (end - p < count) return false;
+
+    value = 0;
+    for (int i = 0; i < count; i++) {
+        if (!IsDigit(p[i])) return false;
+        value = value * 10 + (p[i] - '0');
+    }
+
+    p += count;
+    return true;
+}
+
+
+int DaysInMonth(int year, int month) {
+    static const int days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+    if (month == 2 && year % 4 == 0 && (year % 100 != 0 || year % 400 == 0)) {
+        return 29;
+    }
+
+    return days[month - 1];
+}
+
+
+struct DateTime {
+    int year, month, day, hour, minute, second, msecond;
+    bool hasTime;
+};
+
+
+// Accepts YYYY-MM-DD, optionally followed by THH:MM[:SS[.fff]] (a space may
+// be used instead of the T)
+bool ParseDate(const char* value, size_t length, DateTime& date) {
+    const char *p = value, *end = value + length;
+
+    date.hour = date.minute = date.second = date.msecond = 0;
+    date.hasTime = false;
+
+    if (!ParseDigits(p, end, 4, date.year) || p == end || *p++ != '-' ||
+        !ParseDigits(p, end, 2, date.month) || p == end || *p++ != '-' ||
+        !ParseDigits(p, end, 2, date.day))
+    {
+        return false;
+    }
+
+    if (p != end) {
+        if (*p != 'T' && *p != ' ') return false;
+        p++;
+
+        if (!ParseDigits(p, end, 2, date.hour) || p == end || *p++ != ':' ||
+            !ParseDigits(p, end, 2, date.minute))
+        {
+            return false;
+        }
+
+        if (p != end && *p == ':') {
+            p++;
+            if (!ParseDigits(p, end, 2, date.second)) return false;
+
+            if (p != end && *p == '.') {
+                int digits = 0;
+
+                for (p++; p != end && IsDigit(*p); p++) {
+                    if (digits++ < 3) date.msecond = date.msecond * 10 + (*p - '0');
+                }
+
+                if (digits == 0) return false;
+                for (; digits < 3; digits++) date.msecond *= 10;
+            }
+        }
+
+        date.hasTime = true;
+    }
+
+    return p == end &&
+        date.month >= 1 && date.month <= 12 &&
+        date.day >= 1 && date.day <= DaysInMonth(date.year, date.month) &&
+        date.hour < 24 && date.minute < 60 && date.second < 60;
+}
+
+
+}
+
+
+CsvWriter::CsvWriter(int rowFirst, int rowLast, int colFirst, int colLast,
+        char delimiter, char quote) :
+    rowFirst(rowFirst),
+    rowLast(rowLast),
+    colFirst(colFirst),
+    colLast(colLast),
+    delimiter(delimiter),
+    quote(quote),
+    file(NULL),
+    errorMessage(NULL)
+{
+    memset(special, 0, sizeof(special));
+
+    special[static_cast<unsigned char>(delimiter)] = true;
+    special[static_cast<unsigned char>(quote)] = true;
+    special[static_cast<unsigned char>('\n')] = true;
+    special[static_cast<unsigned char>('\r')] = true;
+}
+
+
+const std::vector<char>& CsvWriter::Data() const {
+    return data;
+}
+
+
+const char* CsvWriter::ErrorMessage() const {
+    return errorMessage;
+}
+
+
+bool CsvWriter::Write(libxl::Book* book, libxl::Sheet* sheet,
+    const std::string& path)
+{
+    errorMessage = NULL;
+    data.clear();
+    util::ResolveRange(sheet, rowFirst, rowLast, colFirst, colLast);
+
+    if (!path.empty()) {
+        file = fopen(path.c_str(), "wb");
+
+        if (!file) {
+            errorMessage = ERROR_OPEN_WRITE;
+            return false;
+        }
+    }
+
+    bool success = WriteRows(book, sheet);
+
+    if (file) {
+        success = success && Flush();
+
+        if (fclose(file) != 0 && success) {
+            errorMessage = ERROR_WRITE;
+            success = false;
+        }
+
+        file = NULL;
+    }
+
+    return success;
+}
+
+
+bool CsvWriter::WriteRows(libxl::Book* book, libxl::Sheet* sheet) {
+    char buffer[util::NUMBER_BUFFER_SIZE];
+
+    for (int row = rowFirst; row <= rowLast; row++) {
+        for (int col = colFirst; col <= colLast; col++) {
+            if (col > colFirst) data.push_back(delimiter);
+
+            switch (sheet->cellType(row, col)) {
+                case libxl::CELLTYPE_STRING: {
+                    const char* value = sheet->readStr(row, col);
+                    if (!value) return false;
+
+                    AppendField(value, strlen(value));
+                    break;
+                }
+
+                case libxl::CELLTYPE_NUMBER: {
+                    double value = sheet->readNum(row, col);
+                    size_t length = sheet->isDate(row, col) ?
+                        FormatDate(book, value, buffer) :
+                        util::FormatNumber(value, buffer);
+
+                    AppendField(buffer, length);
+                    break;
+                }
+
+                case libxl::CELLTYPE_BOOLEAN:
+                    if (sheet->readBool(row, col)) {
+                        AppendField("true", 4);
+                    } else {
+                        AppendField("false", 5);
+                    }
+
+                    break;
+
+                default:
+                    break;
+            }
+        }
+
+        data.push_back('\n');
+
+        if (file && data.size() >= FLUSH_SIZE && !Flush()) return false;
+    }
+
+    return true;
+}
+
+
+void CsvWriter::AppendField(const char* value, size_t length) {
+    bool needsQuotes = false;
+
+    for (size_t i = 0; i < length && !needsQuotes; i++) {
+        needsQuotes = special[static_cast<unsigned char>(value[i])];
+    }
+
+    if (!needsQuotes) {
+        data.insert(data.end(), value, value + length);
+        return;
+    }
+
+    data.push_back(quote);
+
+    for (size_t i = 0; i < length; i++) {
+        if (value[i] == quote) data.push_back(quote);
+        data.push_back(value[i]);
+    }
+
+    data.push_back(quote);
+}
+
+
+bool CsvWriter::Flush() {
+    if (!data.empty() && fwrite(&data[0], 1, data.size(), file) != data.size()) {
+        errorMessage = ERROR_WRITE;
+        return false;
+    }
+
+    data.clear();
+    return true;
+}
+
+
+CsvReader::CsvReader(int row, int col, char delimiter, char quote,
+        bool inferTypes, const std::vector<libxl::Format*>& formats) :
+    row(row),
+    col(col),
+    delimiter(delimiter),
+    quote(quote),
+    inferTypes(inferTypes),
+    formats(formats),
+    dateFormat(NULL),
+    dateTimeFormat(NULL),
+    errorMessage(NULL)
+{
+    memset(special, 0, sizeof(special));
+
+    special[static_cast<unsigned char>(delimiter)] = true;
+    special[static_cast<unsigned char>('\n')] = true;
+    special[static_cast<unsigned char>('\r')] = true;
+}
+
+
+const char* CsvReader::ErrorMessage() const {
+    return errorMessage;
+}
+
+
+bool CsvReader::ReadFile(libxl::Book* book, libxl::Sheet* sheet,
+    const std::string& path)
+{
+    FILE* file = fopen(path.c_str(), "rb");
+
+    if (!file) {
+        errorMessage = ERROR_OPEN_READ;
+        return false;
+    }
+
+    std::vector<char> data;
+    char buffer[65536];
+    size_t count;
+
+    while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        data.insert(data.end(), buffer, buffer + count);
+    }
+
+    bool readError = ferror(file) != 0;
+    fclose(file);
+
+    if (readError) {
+        errorMessage = ERROR_READ;
+        return false;
+    }
+
+    return Read(book, sheet, data.empty() ? NULL : &data[0], data.size());
+}
+
+
+bool CsvReader::Read(libxl::Book* book, libxl::Sheet* sheet,
+    const char* data, size_t size)
+{
+    const char *p = data, *end = data + size;
+    int currentRow = row, currentCol = col;
+
+    errorMessage = NULL;
+
+    // Skip the UTF-8 byte order mark
+    if (size >= 3 && memcmp(p, "\xEF\xBB\xBF", 3) == 0) p += 3;
+
+    while (p < end) {
+        const char* value;
+        size_t length;
+        bool quoted = *p == quote;
+
+        if (quoted) {
+            field.clear();
+
+            // Doubled quotes are unescaped, an unterminated quote extends to
+            // the end of the input
+            for (p++; ; ) {
+                const char* next = static_cast<const char*>(
+                    memchr(p, quote, end - p));
+
+                if (!next) {
+                    field.append(p, end);
+                    p = end;
+                    break;
+                }
+
+                field.append(p, next);
+                p = next + 1;
+
+                if (p == end || *p != quote) break;
+
+                field.push_back(quote);
+                p++;
+            }
+
+            // Anything between the closing quote and the end of the field is
+            // ignored
+            p = FindFieldEnd(p, end);
+
+            value = field.data();
+            length = field.size();
+        } else {
+            const char* next = FindFieldEnd(p, end);
+
+            value = p;
+            length = next - p;
+            p = next;
+        }
+
+        if (!WriteField(book, sheet, currentRow, currentCol, value, length,
+            quoted))
+        {
+            return false;
+        }
+
+        if (p == end) break;
+
+        if (*p == delimiter) {
+            p++;
+            currentCol++;
+
+            // A trailing delimiter ends with an empty field
+            if (p == end) {
+                return WriteField(book, sheet, currentRow, currentCol, NULL, 0,
+                    false);
+            }
+        } else {
+            if (*p == '\r' && end - p > 1 && p[1] == '\n') p++;
+
+            p++;
+            currentRow++;
+            currentCol = col;
+        }
+    }
+
+    return true;
+}
+
+
+const char* CsvReader::FindFieldEnd(const char* p, const char* end) const {
+    // Test eight bytes at a time for delimiters and line breaks with the
+    // "has zero byte" trick, the exact position is then located bytewise
+    const uint64_t ones = 0x0101010101010101ULL, highBits = 0x8080808080808080ULL,
+        delimiters = ones * static_cast<unsigned char>(delimiter),
+        newlines = ones * '\n',
+        returns = ones * '\r';
+
+    while (end - p >= 8) {
+        uint64_t word;
+        memcpy(&word, p, sizeof(word));
+
+        uint64_t a = word ^ delimiters, b = word ^ newlines, c = word ^ returns;
+        if ((((a - ones) & ~a) | ((b - ones) & ~b) | ((c - ones) & ~c)) & highBits) {
+            break;
+        }
+
+        p += 8;
+    }
+
+    while (p < end && !special[static_cast<unsigned char>(*p)]) p++;
+
+    return p;
+}
+
+
+bool CsvReader::WriteField(libxl::Book* book, libxl::Sheet* sheet, int row,
+    int col, const char* value, size_t length, bool quoted)
+{
+    size_t index = col - this->col;
+    libxl::Format* format = index < formats.size() ? formats[index] : NULL;
+
+    // Only unquoted empty fields are blank, "" is an empty string
+    if (length == 0 && !quoted) {
+        return format ? sheet->writeBlank(row, col, format) : true;
+    }
+
+    // libxl expects zero terminated strings, quoted fields are already
+    // unescaped into the scratch string
+    if (value != field.data()) field.assign(value, length);
+    const char* str = field.c_str();
+
+    // Quoted fields are always strings
+    if (inferTypes && !quoted) {
+        double number;
+        bool boolean;
+        DateTime date;
+
+        if (ParseNumber(str, length, number)) {
+            return sheet->writeNum(row, col, number, format);
+        }
+
+        if (ParseBoolean(str, length, boolean)) {
+            return sheet->writeBool(row, col, boolean, format);
+        }
+
+        if (ParseDate(str, length, date)) {
+            if (!format) format = DateFormat(book, date.hasTime);
+            if (!format) return false;
+
+            return sheet->writeNum(row, col, book->datePack(date.year,
+                date.month, date.day, date.hour, date.minute, date.second,
+                date.msecond), format);
+        }
+    }
+
+    return sheet->writeStr(row, col, str, format);
+}
+
+
+libxl::Format* CsvReader::DateFormat(libxl::Book* book, bool hasTime) {
+    libxl::Format*& format = hasTime ? dateTimeFormat : dateFormat;
+
+    if (!format) {
+        format = book->addFormat();
+
+        if (format) {
+            format->setNumFormat(hasTime ?
+                libxl::NUMFORMAT_CUSTOM_MDYYYY_HMM : libxl::NUMFORMAT_DATE);
+        }
+    }
+
+    return format;
+}
+
+
+}
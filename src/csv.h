@@ -0,0 +1,119 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 Christian Speckner <cnspeckn@googlemail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef BINDINGS_CSV_H
+#define BINDINGS_CSV_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "common.h"
+
+namespace node_libxl {
+
+
+// Writes a sheet range as CSV, either to a file or into memory. Dates are
+// written as ISO 8601 strings and bounds may be util::RANGE_DEFAULT. Does not
+// touch V8 and may run on a worker thread.
+class CsvWriter {
+    public:
+
+        CsvWriter(int rowFirst, int rowLast, int colFirst, int colLast,
+            char delimiter, char quote);
+
+        // Writes to the file at path, or into Data() if path is empty
+        bool Write(libxl::Book* book, libxl::Sheet* sheet,
+            const std::string& path);
+
+        const std::vector<char>& Data() const;
+
+        // NULL if the failure was reported by libxl
+        const char* ErrorMessage() const;
+
+    private:
+
+        CsvWriter(const CsvWriter&);
+        const CsvWriter& operator=(const CsvWriter&);
+
+        bool WriteRows(libxl::Book* book, libxl::Sheet* sheet);
+        void AppendField(const char* value, size_t length);
+        bool Flush();
+
+        int rowFirst, rowLast, colFirst, colLast;
+        char delimiter, quote;
+
+        // Characters that force a field to be quoted
+        bool special[256];
+
+        FILE* file;
+        std::vector<char> data;
+        const char* errorMessage;
+};
+
+
+// Parses CSV and writes the fields to a sheet. With type inference, unquoted
+// numbers, booleans (true / false) and ISO 8601 dates are written as such, all
+// other fields as strings. Does not touch V8 and may run on a worker thread.
+class CsvReader {
+    public:
+
+        CsvReader(int row, int col, char delimiter, char quote,
+            bool inferTypes, const std::vector<libxl::Format*>& formats);
+
+        bool Read(libxl::Book* book, libxl::Sheet* sheet, const char* data,
+            size_t size);
+        bool ReadFile(libxl::Book* book, libxl::Sheet* sheet,
+            const std::string& path);
+
+        // NULL if the failure was reported by libxl
+        const char* ErrorMessage() const;
+
+    private:
+
+        CsvReader(const CsvReader&);
+        const CsvReader& operator=(const CsvReader&);
+
+        const char* FindFieldEnd(const char* begin, const char* end) const;
+        bool WriteField(libxl::Book* book, libxl::Sheet* sheet, int row,
+            int col, const char* value, size_t length, bool quoted);
+        libxl::Format* DateFormat(libxl::Book* book, bool hasTime);
+
+        int row, col;
+        char delimiter, quote;
+        bool inferTypes;
+        std::vector<libxl::Format*> formats;
+
+        // Characters that end an unquoted field
+        bool special[256];
+
+        libxl::Format *dateFormat, *dateTimeFormat;
+        std::string field;
+        const char* errorMessage;
+};
+
+
+}
+
+#endif // BINDINGS_CSV_H
@@ -0,0 +1,186 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 Christian Speckner <cnspeckn@googlemail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "external_strings.h"
+
+#include <algorithm>
+#include <climits>
+
+using namespace v8;
+
+namespace node_libxl {
+
+
+namespace {
+
+
+// Rewrites UTF-8 in place as Latin-1. Fails without touching value if it
+// contains characters beyond U+00FF (or anything but ASCII on node versions
+// that only support external ASCII strings).
+bool ToOneByte(std::string& value) {
+    size_t length = 0;
+
+    for (size_t i = 0; i < value.size(); i++) {
+        unsigned char c = value[i];
+
+        if (c < 0x80) {
+            length++;
+            continue;
+        }
+
+#if (NODE_MODULE_VERSION > 0x000B)
+        if ((c == 0xc2 || c == 0xc3) && i + 1 < value.size() &&
+            (static_cast<unsigned char>(value[i + 1]) & 0xc0) == 0x80)
+        {
+            length++;
+            i++;
+            continue;
+        }
+#endif
+
+        return false;
+    }
+
+    if (length == value.size()) return true;
+
+    size_t out = 0;
+    for (size_t i = 0; i < value.size(); i++, out++) {
+        unsigned char c = value[i];
+
+        if (c < 0x80) {
+            value[out] = c;
+        } else {
+            value[out] = static_cast<char>(((c & 0x03) << 6) |
+                (static_cast<unsigned char>(value[++i]) & 0x3f));
+        }
+    }
+
+    value.resize(out);
+
+    return true;
+}
+
+
+// Nan::AdjustExternalMemory takes an int, larger changes are split up
+void AdjustExternalMemory(int64_t change) {
+    while (change != 0) {
+        int64_t step = std::max<int64_t>(-INT_MAX,
+            std::min<int64_t>(change, INT_MAX));
+
+        Nan::AdjustExternalMemory(static_cast<int>(step));
+        change -= step;
+    }
+}
+
+
+}
+
+
+class ExternalStringTable::Resource :
+    public Nan::ExternalOneByteStringResource
+{
+    public:
+
+        Resource(ExternalStringTable* table, const std::string& value) :
+            table(table),
+            value(value)
+        {
+            table->refs++;
+        }
+
+        virtual ~Resource() {
+            table->Release();
+        }
+
+        virtual const char* data() const {
+            return value.data();
+        }
+
+        virtual size_t length() const {
+            return value.size();
+        }
+
+    private:
+
+        ExternalStringTable* table;
+        const std::string& value;
+
+        Resource(const Resource&);
+        const Resource& operator=(const Resource&);
+};
+
+
+// Lifecycle
+
+
+int64_t ExternalStringTable::releasedBytes = 0;
+
+
+ExternalStringTable::ExternalStringTable() :
+    refs(1),
+    externalBytes(0)
+{
+    ReportReleasedMemory();
+}
+
+
+ExternalStringTable::~ExternalStringTable() {
+    releasedBytes += externalBytes;
+}
+
+
+void ExternalStringTable::FlushReleasedMemory() {
+    int64_t bytes = releasedBytes;
+
+    releasedBytes = 0;
+    AdjustExternalMemory(-bytes);
+}
+
+
+void ExternalStringTable::Release() {
+    if (--refs == 0) delete this;
+}
+
+
+// Strings
+
+
+bool ExternalStringTable::Adopt(std::string& value, Local<String>& result) {
+    if (value.size() < MIN_LENGTH || !ToOneByte(value)) return false;
+
+    // Deque elements never move, so the resource can point into the table
+    strings.push_back(std::string());
+    strings.back().swap(value);
+
+    result = Nan::New<String>(new Resource(this, strings.back()))
+        .ToLocalChecked();
+    int64_t size = strings.back().size();
+    externalBytes += size;
+    AdjustExternalMemory(size);
+
+    return true;
+}
+
+
+}
@@ -0,0 +1,84 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 Christian Speckner <cnspeckn@googlemail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef BINDINGS_EXTERNAL_STRINGS_H
+#define BINDINGS_EXTERNAL_STRINGS_H
+
+#include <deque>
+#include <string>
+
+#include "common.h"
+
+namespace node_libxl {
+
+
+// Takes over large strings from a range snapshot and exposes them as
+// external one byte JS strings instead of copying them onto the V8 heap.
+// Every external string holds a reference on the table, which frees the
+// adopted data once the last of them has been collected. Main thread only.
+class ExternalStringTable {
+    public:
+
+        // Strings shorter than this are cheaper to copy
+        static const size_t MIN_LENGTH = 1024;
+
+        ExternalStringTable();
+
+        // Converts value to Latin-1 if possible and moves it into the table,
+        // leaving value empty. Returns false (and leaves value untouched) if
+        // the string is too short or cannot be represented as one byte string.
+        bool Adopt(std::string& value, v8::Local<v8::String>& result);
+
+        // Drops the reference of the creator
+        void Release();
+
+        // Tables are freed from the dispose callbacks of their strings, which
+        // run during GC where V8's memory accounting must not be touched. The
+        // freed bytes are reported from the next call into the addon instead.
+        static void ReportReleasedMemory() {
+            if (releasedBytes) FlushReleasedMemory();
+        }
+
+    private:
+
+        class Resource;
+
+        ~ExternalStringTable();
+
+        static void FlushReleasedMemory();
+
+        static int64_t releasedBytes;
+
+        std::deque<std::string> strings;
+        size_t refs;
+        int64_t externalBytes;
+
+        ExternalStringTable(const ExternalStringTable&);
+        const ExternalStringTable& operator=(const ExternalStringTable&);
+};
+
+
+}
+
+#endif // BINDINGS_EXTERNAL_STRINGS_H
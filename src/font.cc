@@ -26,6 +26,7 @@
 
 #include "assert.h"
 #include "util.h"
+#include "utf8_string.h"
 #include "argument_helper.h"
 
 using namespace v8;
@@ -42,12 +43,26 @@ Font::Font(libxl::Font* font, Local<Value> book) :
 {}
 
 
+Font::~Font() {
+    if (GetBook()) {
+        GetBook()->GetFontCache().Remove(wrapped, this);
+    }
+}
+
+
 Local<Object> Font::NewInstance(
     libxl::Font* libxlFont,
     Local<Value> book)
 {
     Nan::EscapableHandleScope scope;
 
+    Book* parent = Book::Unwrap(book);
+    Font* cached = parent ? parent->GetFontCache().Get(libxlFont) : NULL;
+
+    if (cached) {
+        return scope.Escape(cached->handle());
+    }
+
     Font* font = new Font(libxlFont, book);
 
     Local<Object> that = util::CallStubConstructor(
@@ -55,6 +70,10 @@ Local<Object> Font::NewInstance(
 
     font->Wrap(that);
 
+    if (parent) {
+        parent->GetFontCache().Set(libxlFont, font);
+    }
+
     return scope.Escape(that);
 }
 
@@ -271,7 +290,7 @@ NAN_METHOD(Font::SetName) {
 
     ArgumentHelper arguments(info);
 
-    String::Utf8Value name(arguments.GetString(0));
+    Utf8String name(arguments.GetString(0));
     ASSERT_ARGUMENTS(arguments);
 
     Font* that = Unwrap(info.This());
@@ -317,6 +336,7 @@ void Font::Initialize(Handle<Object> exports) {
     Nan::SetPrototypeMethod(t, "setName", SetName);
 
     t->ReadOnlyPrototype();
+    constructorTemplate.Reset(t);
     constructor.Reset(t->GetFunction());
 
     NODE_DEFINE_CONSTANT(exports, UNDERLINE_NONE);
@@ -38,6 +38,7 @@ class Font : public Wrapper<libxl::Font> , public BookWrapper
     public:
 
         Font(libxl::Font* font, v8::Local<v8::Value> book);
+        ~Font();
 
         static void Initialize(v8::Handle<v8::Object> exports);
         
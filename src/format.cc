@@ -42,12 +42,27 @@ Format::Format(libxl::Format* format, Local<Value> book) :
 {}
 
 
+Format::~Format() {
+    if (GetBook()) {
+        GetBook()->GetFormatCache().Remove(wrapped, this);
+    }
+}
+
+
 Local<Object> Format::NewInstance(
     libxl::Format* libxlFormat,
     Local<Value> book)
 {
     Nan::EscapableHandleScope scope;
 
+    Book* parent = Book::Unwrap(book);
+    Format* cached = parent ?
+        parent->GetFormatCache().Get(libxlFormat) : NULL;
+
+    if (cached) {
+        return scope.Escape(cached->handle());
+    }
+
     Format* format = new Format(libxlFormat, book);
 
     Local<Object> that = 
@@ -55,6 +70,10 @@ Local<Object> Format::NewInstance(
 
     format->Wrap(that);
 
+    if (parent) {
+        parent->GetFormatCache().Set(libxlFormat, format);
+    }
+
     return scope.Escape(that);
 }
 
@@ -782,6 +801,7 @@ void Format::Initialize(Handle<Object> exports) {
     Nan::SetPrototypeMethod(t, "setLocked", SetLocked);
 
     t->ReadOnlyPrototype();
+    constructorTemplate.Reset(t);
     constructor.Reset(t->GetFunction());
 
     NODE_DEFINE_CONSTANT(exports, NUMFORMAT_GENERAL);
@@ -37,6 +37,7 @@ class Format : public Wrapper<libxl::Format>, public BookWrapper
     public:
 
         Format(libxl::Format* format, v8::Local<v8::Value> book);
+        ~Format();
 
         static void Initialize(v8::Handle<v8::Object> exports);
         
@@ -0,0 +1,83 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 Christian Speckner <cnspeckn@googlemail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "object_shape.h"
+
+using namespace v8;
+
+namespace node_libxl {
+
+
+ObjectShape::ObjectShape(const char* const* names) :
+    names(names),
+    count(0),
+    keys(NULL)
+{
+    while (names[count]) count++;
+}
+
+
+void ObjectShape::Initialize() {
+    Local<ObjectTemplate> t = Nan::New<ObjectTemplate>();
+
+    // Shapes live as long as the addon, the keys are never released
+    keys = new Nan::Persistent<String>[count];
+
+    for (size_t i = 0; i < count; i++) {
+        Local<String> key = CSNanNewInternalizedString(names[i]);
+
+        keys[i].Reset(key);
+        t->Set(key, Nan::Undefined());
+    }
+
+    objectTemplate.Reset(t);
+}
+
+
+Local<Object> ObjectShape::NewInstance(Local<Value>* values) {
+    Nan::EscapableHandleScope scope;
+
+    if (!keys) Initialize();
+
+    Local<Object> object =
+        Nan::NewInstance(Nan::New(objectTemplate)).ToLocalChecked();
+
+    Assign(object, values);
+
+    return scope.Escape(object);
+}
+
+
+void ObjectShape::Assign(Local<Object> object, Local<Value>* values) {
+    Nan::HandleScope scope;
+
+    if (!keys) Initialize();
+
+    for (size_t i = 0; i < count; i++) {
+        object->Set(Nan::New(keys[i]), values[i]);
+    }
+}
+
+
+}
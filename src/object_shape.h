@@ -0,0 +1,66 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 Christian Speckner <cnspeckn@googlemail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef BINDINGS_OBJECT_SHAPE_H
+#define BINDINGS_OBJECT_SHAPE_H
+
+#include "common.h"
+
+namespace node_libxl {
+
+
+// A fixed list of property names for result objects. The keys are
+// internalized once and all instances are created from the same object
+// template, so they share a hidden class and filling them in does not add
+// properties. V8 handles are created lazily on first use.
+class ObjectShape {
+    public:
+
+        // names is a NULL terminated list which must outlive the shape
+        explicit ObjectShape(const char* const* names);
+
+        // values holds one value per name, in the same order
+        v8::Local<v8::Object> NewInstance(v8::Local<v8::Value>* values);
+
+        // Sets the properties on an existing object, e.g. to reuse a result
+        void Assign(v8::Local<v8::Object> object, v8::Local<v8::Value>* values);
+
+    private:
+
+        void Initialize();
+
+        const char* const* names;
+        size_t count;
+
+        Nan::Persistent<v8::String>* keys;
+        Nan::Persistent<v8::ObjectTemplate> objectTemplate;
+
+        ObjectShape(const ObjectShape&);
+        const ObjectShape& operator=(const ObjectShape&);
+};
+
+
+}
+
+#endif // BINDINGS_OBJECT_SHAPE_H
@@ -0,0 +1,536 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 Christian Speckner <cnspeckn@googlemail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "range_snapshot.h"
+
+#include <cstring>
+#include <limits>
+
+#include "util.h"
+#include "string_pool.h"
+#include "external_strings.h"
+
+using namespace v8;
+
+namespace node_libxl {
+
+
+namespace {
+
+
+const char BINARY_MAGIC[4] = {'X', 'L', 'R', 'B'};
+const uint32_t BINARY_VERSION = 1;
+
+enum {
+    HEADER_MAGIC,
+    HEADER_VERSION,
+    HEADER_ROWS,
+    HEADER_COLS,
+    HEADER_NUMBERS,
+    HEADER_STRING_REFS,
+    HEADER_STRINGS,
+    HEADER_STRING_BYTES,
+    HEADER_FIELDS
+};
+
+const size_t HEADER_SIZE = HEADER_FIELDS * sizeof(uint32_t);
+
+
+size_t Align(size_t size) {
+    return (size + 7) & ~static_cast<size_t>(7);
+}
+
+
+// Section sizes of the binary encoding. All sections start at 8 byte
+// boundaries, so numbers can be read directly from the buffer.
+struct BinaryLayout {
+    BinaryLayout(size_t cellCount, size_t numberCount, size_t stringRefCount,
+            size_t stringCount, size_t stringBytes) :
+        tags(HEADER_SIZE),
+        numbers(Align(tags + cellCount)),
+        stringRefs(numbers + numberCount * sizeof(double)),
+        stringOffsets(Align(stringRefs + stringRefCount * sizeof(uint32_t))),
+        stringData(stringOffsets + (stringCount + 1) * sizeof(uint32_t)),
+        size(stringData + stringBytes)
+    {}
+
+    size_t tags, numbers, stringRefs, stringOffsets, stringData, size;
+};
+
+
+bool IsNumberOrBoolean(uint8_t type) {
+    return type == libxl::CELLTYPE_NUMBER || type == libxl::CELLTYPE_BOOLEAN;
+}
+
+
+}
+
+
+RangeSnapshot::RangeSnapshot() :
+    rowFirst(0),
+    rowLast(-1),
+    colFirst(0),
+    colLast(-1),
+    readFormulas(false)
+{}
+
+
+RangeSnapshot::RangeSnapshot(int rowFirst, int rowLast, int colFirst,
+        int colLast, bool readFormulas) :
+    rowFirst(rowFirst),
+    rowLast(rowLast),
+    colFirst(colFirst),
+    colLast(colLast),
+    readFormulas(readFormulas)
+{}
+
+
+int RangeSnapshot::RowCount() const {
+    return rowLast >= rowFirst ? rowLast - rowFirst + 1 : 0;
+}
+
+
+int RangeSnapshot::ColCount() const {
+    return colLast >= colFirst ? colLast - colFirst + 1 : 0;
+}
+
+
+bool RangeSnapshot::Read(libxl::Sheet* sheet) {
+    size_t size = static_cast<size_t>(RowCount()) * ColCount();
+
+    types.assign(size, libxl::CELLTYPE_EMPTY);
+    values.assign(size, 0);
+    strings.clear();
+
+    StringIndex stringIndex;
+    size_t index = 0;
+
+    for (int row = rowFirst; row <= rowLast; row++) {
+        for (int col = colFirst; col <= colLast; col++, index++) {
+            libxl::CellType cellType = sheet->cellType(row, col);
+
+            if (readFormulas && cellType != libxl::CELLTYPE_EMPTY &&
+                sheet->isFormula(row, col))
+            {
+                const char* formula = sheet->readFormula(row, col);
+                if (!formula) return false;
+
+                types[index] = libxl::CELLTYPE_STRING;
+                values[index] = AddString(formula, stringIndex);
+
+                continue;
+            }
+
+            switch (cellType) {
+                case libxl::CELLTYPE_NUMBER:
+                    values[index] = sheet->readNum(row, col);
+                    break;
+
+                case libxl::CELLTYPE_BOOLEAN:
+                    values[index] = sheet->readBool(row, col);
+                    break;
+
+                case libxl::CELLTYPE_STRING: {
+                    const char* value = sheet->readStr(row, col);
+                    if (!value) return false;
+
+                    values[index] = AddString(value, stringIndex);
+                    break;
+                }
+
+                default:
+                    break;
+            }
+
+            types[index] = cellType;
+        }
+    }
+
+    return true;
+}
+
+
+uint32_t RangeSnapshot::AddString(const char* value, StringIndex& index) {
+    std::pair<StringIndex::iterator, bool> result = index.insert(
+        StringIndex::value_type(value, strings.size()));
+
+    if (result.second) {
+        strings.push_back(result.first->first);
+    }
+
+    return result.first->second;
+}
+
+
+bool RangeSnapshot::Write(libxl::Sheet* sheet, int row, int col) const {
+    int rowCount = RowCount(), colCount = ColCount();
+    size_t index = 0;
+
+    for (int i = 0; i < rowCount; i++) {
+        for (int j = 0; j < colCount; j++, index++) {
+            bool success = true;
+
+            switch (types[index]) {
+                case libxl::CELLTYPE_NUMBER:
+                    success = sheet->writeNum(row + i, col + j, values[index]);
+                    break;
+
+                case libxl::CELLTYPE_BOOLEAN:
+                    success = sheet->writeBool(row + i, col + j, values[index] != 0);
+                    break;
+
+                case libxl::CELLTYPE_STRING:
+                    success = sheet->writeStr(row + i, col + j,
+                        strings[static_cast<size_t>(values[index])].c_str());
+                    break;
+
+                default:
+                    break;
+            }
+
+            if (!success) return false;
+        }
+    }
+
+    return true;
+}
+
+
+bool RangeSnapshot::EncodedSize(size_t& size) const {
+    size_t numberCount = 0, stringRefCount = 0;
+    uint64_t stringBytes = 0;
+
+    for (size_t i = 0; i < types.size(); i++) {
+        if (IsNumberOrBoolean(types[i])) numberCount++;
+        if (types[i] == libxl::CELLTYPE_STRING) stringRefCount++;
+    }
+
+    for (size_t i = 0; i < strings.size(); i++) {
+        stringBytes += strings[i].size();
+    }
+
+    // Counts and string offsets are stored as uint32
+    if (stringBytes > std::numeric_limits<uint32_t>::max() ||
+        types.size() > std::numeric_limits<uint32_t>::max())
+    {
+        return false;
+    }
+
+    size = BinaryLayout(types.size(), numberCount, stringRefCount,
+        strings.size(), static_cast<size_t>(stringBytes)).size;
+
+    return true;
+}
+
+
+void RangeSnapshot::Encode(char* data) const {
+    uint32_t header[HEADER_FIELDS] = {0};
+
+    memcpy(&header[HEADER_MAGIC], BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    header[HEADER_VERSION] = BINARY_VERSION;
+    // Empty ranges are always encoded as 0 x 0
+    bool empty = RowCount() == 0 || ColCount() == 0;
+    header[HEADER_ROWS] = empty ? 0 : RowCount();
+    header[HEADER_COLS] = empty ? 0 : ColCount();
+    header[HEADER_STRINGS] = strings.size();
+
+    for (size_t i = 0; i < types.size(); i++) {
+        if (IsNumberOrBoolean(types[i])) header[HEADER_NUMBERS]++;
+        if (types[i] == libxl::CELLTYPE_STRING) header[HEADER_STRING_REFS]++;
+    }
+
+    // EncodedSize() has checked that the string data fits
+    for (size_t i = 0; i < strings.size(); i++) {
+        header[HEADER_STRING_BYTES] += static_cast<uint32_t>(strings[i].size());
+    }
+
+    BinaryLayout layout(types.size(), header[HEADER_NUMBERS],
+        header[HEADER_STRING_REFS], header[HEADER_STRINGS],
+        header[HEADER_STRING_BYTES]);
+
+    memset(data, 0, layout.size);
+    memcpy(data, header, HEADER_SIZE);
+
+    if (!types.empty()) {
+        memcpy(data + layout.tags, &types[0], types.size());
+    }
+
+    double* numbers = reinterpret_cast<double*>(data + layout.numbers);
+    uint32_t* stringRefs = reinterpret_cast<uint32_t*>(data + layout.stringRefs);
+
+    for (size_t i = 0; i < types.size(); i++) {
+        if (IsNumberOrBoolean(types[i])) {
+            *numbers++ = values[i];
+        } else if (types[i] == libxl::CELLTYPE_STRING) {
+            *stringRefs++ = static_cast<uint32_t>(values[i]);
+        }
+    }
+
+    uint32_t* stringOffsets =
+        reinterpret_cast<uint32_t*>(data + layout.stringOffsets);
+    char* stringData = data + layout.stringData;
+    uint32_t offset = 0;
+
+    for (size_t i = 0; i < strings.size(); i++) {
+        stringOffsets[i] = offset;
+        memcpy(stringData + offset, strings[i].data(), strings[i].size());
+        offset += static_cast<uint32_t>(strings[i].size());
+    }
+
+    stringOffsets[strings.size()] = offset;
+}
+
+
+bool RangeSnapshot::Decode(const char* data, size_t size) {
+    uint32_t header[HEADER_FIELDS];
+
+    if (size < HEADER_SIZE) return false;
+    memcpy(header, data, HEADER_SIZE);
+
+    if (memcmp(&header[HEADER_MAGIC], BINARY_MAGIC, sizeof(BINARY_MAGIC)) != 0 ||
+        header[HEADER_VERSION] != BINARY_VERSION)
+    {
+        return false;
+    }
+
+    uint32_t rows = header[HEADER_ROWS], cols = header[HEADER_COLS];
+
+    // The decoded range has to fit into a sheet, and rows without columns
+    // would not take any space in the buffer
+    if (rows > static_cast<uint32_t>(util::MAX_ROWS) ||
+        cols > static_cast<uint32_t>(util::MAX_COLS) ||
+        (cols == 0 && rows != 0))
+    {
+        return false;
+    }
+
+    uint64_t cellCount = static_cast<uint64_t>(rows) * cols;
+
+    // Guard against overflows in the layout calculation below
+    if (cellCount > size || header[HEADER_NUMBERS] > size ||
+        header[HEADER_STRING_REFS] > size || header[HEADER_STRINGS] > size ||
+        header[HEADER_STRING_BYTES] > size)
+    {
+        return false;
+    }
+
+    BinaryLayout layout(static_cast<uint32_t>(cellCount), header[HEADER_NUMBERS],
+        header[HEADER_STRING_REFS], header[HEADER_STRINGS],
+        header[HEADER_STRING_BYTES]);
+
+    if (layout.size > size) return false;
+
+    rowFirst = 0;
+    rowLast = static_cast<int>(rows) - 1;
+    colFirst = 0;
+    colLast = static_cast<int>(cols) - 1;
+
+    // The buffer passed in from JS is not necessarily aligned, so all
+    // multibyte values are read via memcpy
+    strings.resize(header[HEADER_STRINGS]);
+    for (uint32_t i = 0; i < header[HEADER_STRINGS]; i++) {
+        uint32_t offsets[2];
+        memcpy(offsets, data + layout.stringOffsets + i * sizeof(uint32_t),
+            sizeof(offsets));
+
+        if (offsets[1] < offsets[0] || offsets[1] > header[HEADER_STRING_BYTES]) {
+            return false;
+        }
+
+        strings[i].assign(data + layout.stringData + offsets[0],
+            offsets[1] - offsets[0]);
+    }
+
+    types.assign(data + layout.tags, data + layout.tags + cellCount);
+    values.assign(cellCount, 0);
+
+    uint32_t numberCount = 0, stringRefCount = 0;
+
+    for (size_t i = 0; i < cellCount; i++) {
+        if (types[i] > libxl::CELLTYPE_ERROR) return false;
+
+        if (IsNumberOrBoolean(types[i])) {
+            if (numberCount == header[HEADER_NUMBERS]) return false;
+
+            memcpy(&values[i], data + layout.numbers +
+                numberCount++ * sizeof(double), sizeof(double));
+        } else if (types[i] == libxl::CELLTYPE_STRING) {
+            if (stringRefCount == header[HEADER_STRING_REFS]) return false;
+
+            uint32_t stringRef;
+            memcpy(&stringRef, data + layout.stringRefs +
+                stringRefCount++ * sizeof(uint32_t), sizeof(uint32_t));
+
+            if (stringRef >= strings.size()) return false;
+            values[i] = stringRef;
+        }
+    }
+
+    return numberCount == header[HEADER_NUMBERS] &&
+        stringRefCount == header[HEADER_STRING_REFS];
+}
+
+
+// Must be called in the handle scope that uses the values
+void RangeSnapshot::NewStringValues(StringPool* pool, bool externalStrings,
+    StringValues& stringValues)
+{
+    ExternalStringTable* externalTable =
+        externalStrings ? new ExternalStringTable() : NULL;
+
+    stringValues.resize(strings.size());
+
+    for (size_t i = 0; i < strings.size(); i++) {
+        std::string& value = strings[i];
+        Local<String> external;
+
+        if (externalTable && externalTable->Adopt(value, external)) {
+            stringValues[i] = external;
+        } else if (pool) {
+            stringValues[i] = pool->Get(value.data(), value.size());
+        } else {
+            stringValues[i] = Nan::New<String>(
+                value.data(), static_cast<int>(value.size())).ToLocalChecked();
+        }
+    }
+
+    if (externalTable) externalTable->Release();
+}
+
+
+Local<Value> RangeSnapshot::CellValue(size_t index,
+    const StringValues& stringValues)
+{
+    Nan::EscapableHandleScope scope;
+
+    switch (types[index]) {
+        case libxl::CELLTYPE_NUMBER:
+            return scope.Escape(Nan::New<Number>(values[index]));
+
+        case libxl::CELLTYPE_BOOLEAN:
+            return scope.Escape(Nan::New<Boolean>(values[index] != 0));
+
+        case libxl::CELLTYPE_STRING:
+            return scope.Escape(
+                stringValues[static_cast<size_t>(values[index])]);
+
+        default:
+            return scope.Escape(Nan::Null());
+    }
+}
+
+
+bool RangeSnapshot::IsNumericColumn(int col) const {
+    size_t colCount = ColCount(), index = col;
+    bool hasNumbers = false;
+
+    for (int row = 0; row < RowCount(); row++, index += colCount) {
+        switch (types[index]) {
+            case libxl::CELLTYPE_NUMBER:
+                hasNumbers = true;
+                break;
+
+            case libxl::CELLTYPE_EMPTY:
+            case libxl::CELLTYPE_BLANK:
+                break;
+
+            default:
+                return false;
+        }
+    }
+
+    return hasNumbers;
+}
+
+
+Local<Array> RangeSnapshot::ToRows(StringPool* pool,
+    bool externalStrings)
+{
+    Nan::EscapableHandleScope scope;
+
+    StringValues stringValues;
+    NewStringValues(pool, externalStrings, stringValues);
+
+    int rowCount = RowCount(), colCount = ColCount();
+    Local<Array> result = Nan::New<Array>(rowCount);
+    size_t index = 0;
+
+    for (int row = 0; row < rowCount; row++) {
+        Nan::HandleScope rowScope;
+
+        Local<Array> rowValues = Nan::New<Array>(colCount);
+        for (int col = 0; col < colCount; col++, index++) {
+            rowValues->Set(col, CellValue(index, stringValues));
+        }
+
+        result->Set(row, rowValues);
+    }
+
+    return scope.Escape(result);
+}
+
+
+Local<Array> RangeSnapshot::ToColumns(StringPool* pool,
+    bool externalStrings)
+{
+    Nan::EscapableHandleScope scope;
+
+    StringValues stringValues;
+    NewStringValues(pool, externalStrings, stringValues);
+
+    int rowCount = RowCount(), colCount = ColCount();
+    Local<Array> result = Nan::New<Array>(colCount);
+
+    for (int col = 0; col < colCount; col++) {
+        Nan::HandleScope colScope;
+
+        if (IsNumericColumn(col)) {
+            Local<Object> colValues = util::NewTypedArray("Float64Array", rowCount);
+            Nan::TypedArrayContents<double> contents(colValues);
+            double* data = *contents;
+
+            size_t index = col;
+            for (int row = 0; row < rowCount; row++, index += colCount) {
+                data[row] = types[index] == libxl::CELLTYPE_NUMBER ?
+                    values[index] : std::numeric_limits<double>::quiet_NaN();
+            }
+
+            result->Set(col, colValues);
+        } else {
+            Local<Array> colValues = Nan::New<Array>(rowCount);
+
+            size_t index = col;
+            for (int row = 0; row < rowCount; row++, index += colCount) {
+                colValues->Set(row, CellValue(index, stringValues));
+            }
+
+            result->Set(col, colValues);
+        }
+    }
+
+    return scope.Escape(result);
+}
+
+
+}
@@ -0,0 +1,102 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 Christian Speckner <cnspeckn@googlemail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef BINDINGS_RANGE_SNAPSHOT_H
+#define BINDINGS_RANGE_SNAPSHOT_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "common.h"
+
+namespace node_libxl {
+
+
+class StringPool;
+
+
+// Native copy of the cell values in a rectangular sheet range. Read(),
+// Write() and the binary encoding only talk to libxl and may run on a worker
+// thread, the To* methods build the JS representation and must run on the
+// main thread.
+class RangeSnapshot {
+    public:
+
+        RangeSnapshot();
+        RangeSnapshot(int rowFirst, int rowLast, int colFirst, int colLast,
+            bool readFormulas = false);
+
+        bool Read(libxl::Sheet* sheet);
+        bool Write(libxl::Sheet* sheet, int row, int col) const;
+
+        // Binary layout, see README.md for the format description.
+        // EncodedSize() fails if the snapshot exceeds the uint32 counts and
+        // offsets of the format.
+        bool EncodedSize(size_t& size) const;
+        void Encode(char* data) const;
+        bool Decode(const char* data, size_t size);
+
+        // Each distinct string becomes a single JS string, taken from pool
+        // if given. With externalStrings, large strings are moved out of the
+        // snapshot into external JS strings instead, so the snapshot can be
+        // converted only once.
+        v8::Local<v8::Array> ToRows(StringPool* pool = NULL,
+            bool externalStrings = false);
+        v8::Local<v8::Array> ToColumns(StringPool* pool = NULL,
+            bool externalStrings = false);
+
+        int RowCount() const;
+        int ColCount() const;
+
+    private:
+
+        RangeSnapshot(const RangeSnapshot&);
+        const RangeSnapshot& operator=(const RangeSnapshot&);
+
+        typedef std::map<std::string, uint32_t> StringIndex;
+        typedef std::vector<v8::Local<v8::Value> > StringValues;
+
+        void NewStringValues(StringPool* pool, bool externalStrings,
+            StringValues& stringValues);
+        v8::Local<v8::Value> CellValue(size_t index,
+            const StringValues& stringValues);
+        bool IsNumericColumn(int col) const;
+        uint32_t AddString(const char* value, StringIndex& index);
+
+        int rowFirst, rowLast, colFirst, colLast;
+        bool readFormulas;
+
+        // One type tag per cell, row major. Numbers and booleans live in
+        // values, strings are referenced through their index in the
+        // deduplicated string table.
+        std::vector<uint8_t> types;
+        std::vector<double> values;
+        std::vector<std::string> strings;
+};
+
+
+}
+
+#endif // BINDINGS_RANGE_SNAPSHOT_H
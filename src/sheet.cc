@@ -24,17 +24,87 @@
 
 #include "sheet.h"
 
+#include <vector>
+#include <limits>
+#include <cstring>
+
 #include "assert.h"
 #include "util.h"
+#include "utf8_string.h"
 #include "argument_helper.h"
 #include "format.h"
 #include "async_worker.h"
+#include "range_snapshot.h"
+#include "arrow_ipc.h"
+#include "csv.h"
+#include "buffer_copy.h"
+#include "object_shape.h"
+#include "string_pool.h"
 
 using namespace v8;
 
 namespace node_libxl {
 
 
+// Result shapes
+
+
+namespace {
+
+
+const char* const GET_MERGE_KEYS[] = {
+    "rowFirst", "rowLast", "colFirst", "colLast", NULL
+};
+ObjectShape getMergeShape(GET_MERGE_KEYS);
+
+
+const char* const GET_PICTURE_KEYS[] = {
+    "bookIndex", "rowTop", "colLeft", "rowBottom", "colRight", "width",
+    "height", "offset_x", "offset_y", NULL
+};
+ObjectShape getPictureShape(GET_PICTURE_KEYS);
+
+
+const char* const GET_PRINT_FIT_KEYS[] = {
+    "wPages", "hPages", NULL
+};
+ObjectShape getPrintFitShape(GET_PRINT_FIT_KEYS);
+
+
+const char* const GET_NAMED_RANGE_KEYS[] = {
+    "rowFirst", "rowLast", "colFirst", "colLast", "hidden", NULL
+};
+ObjectShape getNamedRangeShape(GET_NAMED_RANGE_KEYS);
+
+
+const char* const NAMED_RANGE_KEYS[] = {
+    "name", "rowFirst", "rowLast", "colFirst", "colLast", "scopeId",
+    "hidden", NULL
+};
+ObjectShape namedRangeShape(NAMED_RANGE_KEYS);
+
+
+const char* const GET_TOP_LEFT_VIEW_KEYS[] = {
+    "row", "col", NULL
+};
+ObjectShape getTopLeftViewShape(GET_TOP_LEFT_VIEW_KEYS);
+
+
+const char* const ADDR_TO_ROW_COL_KEYS[] = {
+    "row", "col", "rowRelative", "colRelative", NULL
+};
+ObjectShape addrToRowColShape(ADDR_TO_ROW_COL_KEYS);
+
+
+const char* const READ_CELL_KEYS[] = {
+    "type", "value", "format", "isDate", NULL
+};
+ObjectShape readCellShape(READ_CELL_KEYS);
+
+
+}
+
+
 // Lifecycle
 
 Sheet::Sheet(libxl::Sheet* sheet, Local<Value> book) :
@@ -43,12 +113,26 @@ Sheet::Sheet(libxl::Sheet* sheet, Local<Value> book) :
 {}
 
 
+Sheet::~Sheet() {
+    if (GetBook()) {
+        GetBook()->GetSheetCache().Remove(wrapped, this);
+    }
+}
+
+
 Local<Object> Sheet::NewInstance(
     libxl::Sheet* libxlSheet,
     Local<Value> book)
 {
     Nan::EscapableHandleScope scope;
 
+    Book* parent = Book::Unwrap(book);
+    Sheet* cached = parent ? parent->GetSheetCache().Get(libxlSheet) : NULL;
+
+    if (cached) {
+        return scope.Escape(cached->handle());
+    }
+
     Sheet* sheet = new Sheet(libxlSheet, book);
 
     Local<Object> that = util::CallStubConstructor(
@@ -56,6 +140,10 @@ Local<Object> Sheet::NewInstance(
 
     sheet->Wrap(that);
 
+    if (parent) {
+        parent->GetSheetCache().Set(libxlSheet, sheet);
+    }
+
     return scope.Escape(that);
 }
 
@@ -63,7 +151,44 @@ Local<Object> Sheet::NewInstance(
 // Wrappers
 
 
+namespace {
+
+
+// Receiver for the fast paths of the hot scalar accessors, which handle the
+// plain argument forms without ArgumentHelper. Nan::SetPrototypeMethod
+// installs a signature, so V8 has already checked the type of the holder and
+// Wrapper<T>::InstanceOf can be skipped. Returns NULL if the slow path has to
+// run and raise the appropriate error.
+inline Sheet* FastReceiver(Nan::NAN_METHOD_ARGS_TYPE info) {
+    Sheet* that = Nan::ObjectWrap::Unwrap<Sheet>(info.Holder());
+
+    return (that && !that->GetBook()->AsyncPending()) ? that : NULL;
+}
+
+
+inline bool IsCellAddress(Nan::NAN_METHOD_ARGS_TYPE info) {
+    return info[0]->IsInt32() && info[1]->IsInt32();
+}
+
+
+}
+
+
 NAN_METHOD(Sheet::CellType) {
+    Sheet* fastThat = (info.Length() == 2 && IsCellAddress(info)) ?
+        FastReceiver(info) : NULL;
+
+    if (fastThat) {
+        libxl::CellType cellType = fastThat->GetWrapped()->cellType(
+            info[0].As<Int32>()->Value(), info[1].As<Int32>()->Value());
+
+        if (cellType == libxl::CELLTYPE_ERROR) {
+            return util::ThrowLibxlError(fastThat);
+        }
+
+        return info.GetReturnValue().Set(static_cast<int32_t>(cellType));
+    }
+
     Nan::HandleScope scope;
 
     ArgumentHelper arguments(info);
@@ -85,6 +210,14 @@ NAN_METHOD(Sheet::CellType) {
 
 
 NAN_METHOD(Sheet::IsFormula) {
+    Sheet* fastThat = (info.Length() == 2 && IsCellAddress(info)) ?
+        FastReceiver(info) : NULL;
+
+    if (fastThat) {
+        return info.GetReturnValue().Set(fastThat->GetWrapped()->isFormula(
+            info[0].As<Int32>()->Value(), info[1].As<Int32>()->Value()));
+    }
+
     Nan::HandleScope scope;
 
     ArgumentHelper arguments(info);
@@ -149,6 +282,7 @@ NAN_METHOD(Sheet::ReadStr) {
     int row = arguments.GetInt(0);
     int col = arguments.GetInt(1);
     Handle<Value> formatRef = info[2];
+    StringPool* pool = arguments.GetWrapped<StringPool>(3, NULL);
     ASSERT_ARGUMENTS(arguments);
 
     Sheet* that = Unwrap(info.This());
@@ -165,7 +299,11 @@ NAN_METHOD(Sheet::ReadStr) {
             Format::NewInstance(libxlFormat, that->GetBookHandle()));
     }
 
-    info.GetReturnValue().Set(Nan::New<String>(value).ToLocalChecked());
+    if (pool) {
+        info.GetReturnValue().Set(pool->Get(value, strlen(value)));
+    } else {
+        info.GetReturnValue().Set(Nan::New<String>(value).ToLocalChecked());
+    }
 }
 
 
@@ -176,7 +314,7 @@ NAN_METHOD(Sheet::WriteStr) {
 
     int row = arguments.GetInt(0);
     int col = arguments.GetInt(1);
-    String::Utf8Value value(arguments.GetString(2));
+    Utf8String value(arguments.GetString(2));
     Format* format = arguments.GetWrapped<Format>(3, NULL);
     ASSERT_ARGUMENTS(arguments);
 
@@ -197,6 +335,14 @@ NAN_METHOD(Sheet::WriteStr) {
 
 
 NAN_METHOD(Sheet::ReadNum) {
+    Sheet* fastThat = (info.Length() == 2 && IsCellAddress(info)) ?
+        FastReceiver(info) : NULL;
+
+    if (fastThat) {
+        return info.GetReturnValue().Set(fastThat->GetWrapped()->readNum(
+            info[0].As<Int32>()->Value(), info[1].As<Int32>()->Value()));
+    }
+
     Nan::HandleScope scope;
 
     ArgumentHelper arguments(info);
@@ -221,6 +367,19 @@ NAN_METHOD(Sheet::ReadNum) {
 
 
 NAN_METHOD(Sheet::WriteNum) {
+    Sheet* fastThat = (info.Length() == 3 && IsCellAddress(info) &&
+        info[2]->IsNumber()) ? FastReceiver(info) : NULL;
+
+    if (fastThat) {
+        if (!fastThat->GetWrapped()->writeNum(info[0].As<Int32>()->Value(),
+                info[1].As<Int32>()->Value(), info[2].As<Number>()->Value()))
+        {
+            return util::ThrowLibxlError(fastThat);
+        }
+
+        return info.GetReturnValue().Set(info.This());
+    }
+
     Nan::HandleScope scope;
 
     ArgumentHelper arguments(info);
@@ -272,6 +431,19 @@ NAN_METHOD(Sheet::ReadBool) {
 
 
 NAN_METHOD(Sheet::WriteBool) {
+    Sheet* fastThat = (info.Length() == 3 && IsCellAddress(info) &&
+        info[2]->IsBoolean()) ? FastReceiver(info) : NULL;
+
+    if (fastThat) {
+        if (!fastThat->GetWrapped()->writeBool(info[0].As<Int32>()->Value(),
+                info[1].As<Int32>()->Value(), info[2].As<Boolean>()->Value()))
+        {
+            return util::ThrowLibxlError(fastThat);
+        }
+
+        return info.GetReturnValue().Set(info.This());
+    }
+
     Nan::HandleScope scope;
 
     ArgumentHelper arguments(info);
@@ -384,7 +556,7 @@ NAN_METHOD(Sheet::WriteFormula) {
 
     int row = arguments.GetInt(0);
     int col = arguments.GetInt(1);
-    String::Utf8Value value(arguments.GetString(2));
+    Utf8String value(arguments.GetString(2));
     Format* format = arguments.GetWrapped<Format>(3, NULL);
     ASSERT_ARGUMENTS(arguments);
 
@@ -431,8 +603,8 @@ NAN_METHOD(Sheet::WriteComment) {
 
     int row = arguments.GetInt(0);
     int col = arguments.GetInt(1);
-    String::Utf8Value value(arguments.GetString(2));
-    String::Utf8Value author(arguments.GetString(3, ""));
+    Utf8String value(arguments.GetString(2));
+    Utf8String author(arguments.GetString(3, ""));
     int width = arguments.GetInt(4, 129);
     int height = arguments.GetInt(5, 75);
     ASSERT_ARGUMENTS(arguments);
@@ -659,11 +831,13 @@ NAN_METHOD(Sheet::GetMerge) {
         return util::ThrowLibxlError(that);
     }
 
-    Local<Object> result = Nan::New<Object>();
-    result->Set(Nan::New<String>("rowFirst").ToLocalChecked(), Nan::New<Integer>(rowFirst));
-    result->Set(Nan::New<String>("rowLast").ToLocalChecked(),  Nan::New<Integer>(rowLast));
-    result->Set(Nan::New<String>("colFirst").ToLocalChecked(), Nan::New<Integer>(colFirst));
-    result->Set(Nan::New<String>("colLast").ToLocalChecked(),  Nan::New<Integer>(colLast));
+    Local<Value> values[] = {
+        Nan::New<Integer>(rowFirst),
+        Nan::New<Integer>(rowLast),
+        Nan::New<Integer>(colFirst),
+        Nan::New<Integer>(colLast)
+    };
+    Local<Object> result = getMergeShape.NewInstance(values);
 
     info.GetReturnValue().Set(result);
 }
@@ -742,16 +916,18 @@ NAN_METHOD(Sheet::GetPicture) {
         return util::ThrowLibxlError(that);
     }
 
-    Local<Object> result = Nan::New<Object>();
-    result->Set(Nan::New<String>("bookIndex").ToLocalChecked(),    Nan::New<Integer>(bookIndex));
-    result->Set(Nan::New<String>("rowTop").ToLocalChecked(),       Nan::New<Integer>(rowTop));
-    result->Set(Nan::New<String>("colLeft").ToLocalChecked(),      Nan::New<Integer>(colLeft));
-    result->Set(Nan::New<String>("rowBottom").ToLocalChecked(),    Nan::New<Integer>(rowBottom));
-    result->Set(Nan::New<String>("colRight").ToLocalChecked(),     Nan::New<Integer>(colRight));
-    result->Set(Nan::New<String>("width").ToLocalChecked(),        Nan::New<Integer>(width));
-    result->Set(Nan::New<String>("height").ToLocalChecked(),       Nan::New<Integer>(height));
-    result->Set(Nan::New<String>("offset_x").ToLocalChecked(),     Nan::New<Integer>(offset_x));
-    result->Set(Nan::New<String>("offset_y").ToLocalChecked(),     Nan::New<Integer>(offset_y));
+    Local<Value> values[] = {
+        Nan::New<Integer>(bookIndex),
+        Nan::New<Integer>(rowTop),
+        Nan::New<Integer>(colLeft),
+        Nan::New<Integer>(rowBottom),
+        Nan::New<Integer>(colRight),
+        Nan::New<Integer>(width),
+        Nan::New<Integer>(height),
+        Nan::New<Integer>(offset_x),
+        Nan::New<Integer>(offset_y)
+    };
+    Local<Object> result = getPictureShape.NewInstance(values);
 
     info.GetReturnValue().Set(result);
 }
@@ -1077,9 +1253,9 @@ NAN_METHOD(Sheet::InsertRowAsync) {
     ASSERT_ARGUMENTS(arguments);
 
     Sheet* that = Unwrap(info.This());
-    ASSERT_THIS(that);
+    ASSERT_THIS_ASYNC(that);
 
-    Nan::AsyncQueueWorker(new Worker(new Nan::Callback(callback),
+    AsyncQueueWorker(new Worker(new Nan::Callback(callback),
         info.This(), rowFirst, rowLast));
 
     info.GetReturnValue().Set(info.This());
@@ -1136,9 +1312,9 @@ NAN_METHOD(Sheet::InsertColAsync) {
     ASSERT_ARGUMENTS(arguments);
 
     Sheet* that = Unwrap(info.This());
-    ASSERT_THIS(that);
+    ASSERT_THIS_ASYNC(that);
 
-    Nan::AsyncQueueWorker(new Worker(new Nan::Callback(callback), info.This(),
+    AsyncQueueWorker(new Worker(new Nan::Callback(callback), info.This(),
         colFirst, colLast));
 
     info.GetReturnValue().Set(info.This());
@@ -1195,9 +1371,9 @@ NAN_METHOD(Sheet::RemoveRowAsync) {
     ASSERT_ARGUMENTS(arguments);
 
     Sheet* that = Unwrap(info.This());
-    ASSERT_THIS(that);
+    ASSERT_THIS_ASYNC(that);
 
-    Nan::AsyncQueueWorker(new Worker(new Nan::Callback(callback), info.This(),
+    AsyncQueueWorker(new Worker(new Nan::Callback(callback), info.This(),
         rowFirst, rowLast));
 
     info.GetReturnValue().Set(info.This());
@@ -1234,9 +1410,9 @@ NAN_METHOD(Sheet::RemoveColAsync) {
     ASSERT_ARGUMENTS(arguments);
 
     Sheet* that = Unwrap(info.This());
-    ASSERT_THIS(that);
+    ASSERT_THIS_ASYNC(that);
 
-    Nan::AsyncQueueWorker(new Worker(new Nan::Callback(callback), info.This(),
+    AsyncQueueWorker(new Worker(new Nan::Callback(callback), info.This(),
         colFirst, colLast));
 
     info.GetReturnValue().Set(info.This());
@@ -1442,10 +1618,11 @@ NAN_METHOD(Sheet::GetPrintFit) {
     int wPages, hPages;
 
     if (that->GetWrapped()->getPrintFit(&wPages, &hPages)) {
-        Local<Object> result = Nan::New<Object>();
-
-        result->Set(Nan::New<String>("wPages").ToLocalChecked(),   Nan::New<Integer>(wPages));
-        result->Set(Nan::New<String>("hPages").ToLocalChecked(),   Nan::New<Integer>(hPages));
+        Local<Value> values[] = {
+            Nan::New<Integer>(wPages),
+            Nan::New<Integer>(hPages)
+        };
+        Local<Object> result = getPrintFitShape.NewInstance(values);
 
         info.GetReturnValue().Set(result);
     } else {
@@ -1541,7 +1718,7 @@ NAN_METHOD(Sheet::SetHeader) {
 
     ArgumentHelper arguments(info);
 
-    String::Utf8Value header(arguments.GetString(0));
+    Utf8String header(arguments.GetString(0));
     double margin = arguments.GetDouble(1, 0.5);
     ASSERT_ARGUMENTS(arguments);
 
@@ -1582,7 +1759,7 @@ NAN_METHOD(Sheet::SetFooter) {
 
     ArgumentHelper arguments(info);
 
-    String::Utf8Value footer(arguments.GetString(0));
+    Utf8String footer(arguments.GetString(0));
     double margin = arguments.GetDouble(1, 0.5);
     ASSERT_ARGUMENTS(arguments);
 
@@ -1880,7 +2057,7 @@ NAN_METHOD(Sheet::GetNamedRange) {
 
     ArgumentHelper arguments(info);
 
-    String::Utf8Value name(arguments.GetString(0));
+    Utf8String name(arguments.GetString(0));
     int scopeId = arguments.GetInt(1, libxl::SCOPE_UNDEFINED);
     ASSERT_ARGUMENTS(arguments);
 
@@ -1896,12 +2073,14 @@ NAN_METHOD(Sheet::GetNamedRange) {
         return util::ThrowLibxlError(that);
     }
 
-    Local<Object> result = Nan::New<Object>();
-    result->Set(Nan::New<String>("rowFirst").ToLocalChecked(), Nan::New<Integer>(rowFirst));
-    result->Set(Nan::New<String>("rowLast").ToLocalChecked(),  Nan::New<Integer>(rowLast));
-    result->Set(Nan::New<String>("colFirst").ToLocalChecked(), Nan::New<Integer>(colFirst));
-    result->Set(Nan::New<String>("colLast").ToLocalChecked(),  Nan::New<Integer>(colLast));
-    result->Set(Nan::New<String>("hidden").ToLocalChecked(),   Nan::New<Boolean>(hidden));
+    Local<Value> values[] = {
+        Nan::New<Integer>(rowFirst),
+        Nan::New<Integer>(rowLast),
+        Nan::New<Integer>(colFirst),
+        Nan::New<Integer>(colLast),
+        Nan::New<Boolean>(hidden)
+    };
+    Local<Object> result = getNamedRangeShape.NewInstance(values);
 
     info.GetReturnValue().Set(result);
 }
@@ -1912,7 +2091,7 @@ NAN_METHOD(Sheet::SetNamedRange) {
 
     ArgumentHelper arguments(info);
 
-    String::Utf8Value name(arguments.GetString(0));
+    Utf8String name(arguments.GetString(0));
     int rowFirst    = arguments.GetInt(1),
         rowLast     = arguments.GetInt(2),
         colFirst    = arguments.GetInt(3),
@@ -1938,7 +2117,7 @@ NAN_METHOD(Sheet::DelNamedRange) {
 
     ArgumentHelper arguments(info);
 
-    String::Utf8Value name(arguments.GetString(0));
+    Utf8String name(arguments.GetString(0));
     int scopeId = arguments.GetInt(1, libxl::SCOPE_UNDEFINED);
     ASSERT_ARGUMENTS(arguments);
 
@@ -1986,14 +2165,16 @@ NAN_METHOD(Sheet::NamedRange) {
         return util::ThrowLibxlError(that);
     }
 
-    Local<Object> result = Nan::New<Object>();
-    result->Set(Nan::New<String>("name").ToLocalChecked(),     Nan::New<String> (name).ToLocalChecked());
-    result->Set(Nan::New<String>("rowFirst").ToLocalChecked(), Nan::New<Integer>(rowFirst));
-    result->Set(Nan::New<String>("rowLast").ToLocalChecked(),  Nan::New<Integer>(rowLast));
-    result->Set(Nan::New<String>("colFirst").ToLocalChecked(), Nan::New<Integer>(colFirst));
-    result->Set(Nan::New<String>("colLast").ToLocalChecked(),  Nan::New<Integer>(colLast));
-    result->Set(Nan::New<String>("scopeId").ToLocalChecked(),  Nan::New<Integer>(scopeId));
-    result->Set(Nan::New<String>("hidden").ToLocalChecked(),   Nan::New<Boolean>(hidden));
+    Local<Value> values[] = {
+        Nan::New<String>(name).ToLocalChecked(),
+        Nan::New<Integer>(rowFirst),
+        Nan::New<Integer>(rowLast),
+        Nan::New<Integer>(colFirst),
+        Nan::New<Integer>(colLast),
+        Nan::New<Integer>(scopeId),
+        Nan::New<Boolean>(hidden)
+    };
+    Local<Object> result = namedRangeShape.NewInstance(values);
 
     info.GetReturnValue().Set(result);
 }
@@ -2014,7 +2195,7 @@ NAN_METHOD(Sheet::SetName) {
 
     ArgumentHelper arguments(info);
 
-    String::Utf8Value name(arguments.GetString(0));
+    Utf8String name(arguments.GetString(0));
     ASSERT_ARGUMENTS(arguments);
 
     Sheet* that = Unwrap(info.This());
@@ -2118,9 +2299,11 @@ NAN_METHOD(Sheet::GetTopLeftView) {
     int row, col;
     that->GetWrapped()->getTopLeftView(&row, &col);
 
-    Local<Object> result = Nan::New<Object>();
-    result->Set(Nan::New<String>("row").ToLocalChecked(), Nan::New<Integer>(row));
-    result->Set(Nan::New<String>("col").ToLocalChecked(), Nan::New<Integer>(col));
+    Local<Value> values[] = {
+        Nan::New<Integer>(row),
+        Nan::New<Integer>(col)
+    };
+    Local<Object> result = getTopLeftViewShape.NewInstance(values);
 
     info.GetReturnValue().Set(result);
 }
@@ -2149,7 +2332,7 @@ NAN_METHOD(Sheet::AddrToRowCol) {
 
     ArgumentHelper arguments(info);
 
-    String::Utf8Value addr(arguments.GetString(0));
+    Utf8String addr(arguments.GetString(0));
     ASSERT_ARGUMENTS(arguments);
 
     Sheet* that = Unwrap(info.This());
@@ -2160,11 +2343,13 @@ NAN_METHOD(Sheet::AddrToRowCol) {
 
     that->GetWrapped()->addrToRowCol(*addr, &row, &col, &rowRelative, &colRelative);
 
-    Local<Object> result = Nan::New<Object>();
-    result->Set(Nan::New<String>("row").ToLocalChecked(),          Nan::New<Integer>(row));
-    result->Set(Nan::New<String>("col").ToLocalChecked(),          Nan::New<Integer>(col));
-    result->Set(Nan::New<String>("rowRelative").ToLocalChecked(),  Nan::New<Boolean>(rowRelative));
-    result->Set(Nan::New<String>("colRelative").ToLocalChecked(),  Nan::New<Boolean>(colRelative));
+    Local<Value> values[] = {
+        Nan::New<Integer>(row),
+        Nan::New<Integer>(col),
+        Nan::New<Boolean>(rowRelative),
+        Nan::New<Boolean>(colRelative)
+    };
+    Local<Object> result = addrToRowColShape.NewInstance(values);
 
     info.GetReturnValue().Set(result);
 }
@@ -2195,148 +2380,1209 @@ NAN_METHOD(Sheet::RowColToAddr) {
 }
 
 
-// Init
+namespace {
 
 
-void Sheet::Initialize(Handle<Object> exports) {
-    using namespace libxl;
+// Fills the readCell shape values for a cell, taking strings from pool if
+// given. Returns false if libxl fails to read the cell.
+bool ReadCellValues(Sheet* sheet, int row, int col, bool withFormat,
+    bool withDate, StringPool* pool, Local<Value>* values)
+{
+    libxl::Sheet* libxlSheet = sheet->GetWrapped();
+    libxl::CellType cellType = libxlSheet->cellType(row, col);
+    libxl::Format* libxlFormat = NULL;
+    libxl::Format** formatRef = withFormat ? &libxlFormat : NULL;
+    Local<Value> value = Nan::Null();
+
+    switch (cellType) {
+        case libxl::CELLTYPE_NUMBER:
+            value = Nan::New<Number>(libxlSheet->readNum(row, col, formatRef));
+            break;
+
+        case libxl::CELLTYPE_BOOLEAN:
+            value = Nan::New<Boolean>(libxlSheet->readBool(row, col, formatRef));
+            break;
+
+        case libxl::CELLTYPE_STRING: {
+            const char* str = libxlSheet->readStr(row, col, formatRef);
+            if (!str) return false;
+
+            value = pool ? pool->Get(str, strlen(str)) :
+                Nan::New<String>(str).ToLocalChecked();
+            break;
+        }
+
+        case libxl::CELLTYPE_EMPTY:
+            break;
+
+        default:
+            if (withFormat) libxlFormat = libxlSheet->cellFormat(row, col);
+            break;
+    }
+
+    values[0] = Nan::New<Integer>(cellType);
+    values[1] = value;
+
+    if (libxlFormat) {
+        values[2] = Format::NewInstance(libxlFormat, sheet->GetBookHandle());
+    } else {
+        values[2] = Nan::Null();
+    }
 
+    values[3] = Nan::New<Boolean>(withDate &&
+        cellType == libxl::CELLTYPE_NUMBER && libxlSheet->isDate(row, col));
+
+    return true;
+}
+
+
+}
+
+
+NAN_METHOD(Sheet::ReadCell) {
     Nan::HandleScope scope;
 
-    Local<FunctionTemplate> t = Nan::New<FunctionTemplate>(util::StubConstructor);
-    t->SetClassName(Nan::New<String>("Sheet").ToLocalChecked());
-    t->InstanceTemplate()->SetInternalFieldCount(1);
+    ArgumentHelper arguments(info);
 
-    BookWrapper::Initialize<Sheet>(t);
+    int row = arguments.GetInt(0);
+    int col = arguments.GetInt(1);
+    bool withFormat = arguments.GetBooleanOption(2, "withFormat", false);
+    bool withDate = arguments.GetBooleanOption(2, "withDate", false);
+    StringPool* pool = arguments.GetWrappedOption<StringPool>(2, "pool");
+    ASSERT_ARGUMENTS(arguments);
 
-    Nan::SetPrototypeMethod(t, "cellType", CellType);
-    Nan::SetPrototypeMethod(t, "isFormula", IsFormula);
-    Nan::SetPrototypeMethod(t, "cellFormat", CellFormat);
-    Nan::SetPrototypeMethod(t, "setCellFormat", SetCellFormat);
-    Nan::SetPrototypeMethod(t, "readStr", ReadStr);
-    Nan::SetPrototypeMethod(t, "readString", ReadStr);
-    Nan::SetPrototypeMethod(t, "writeString", WriteStr);
-    Nan::SetPrototypeMethod(t, "writeStr", WriteStr);
-    Nan::SetPrototypeMethod(t, "readNum", ReadNum);
-    Nan::SetPrototypeMethod(t, "writeNum", WriteNum);
-    Nan::SetPrototypeMethod(t, "readBool", ReadBool);
-    Nan::SetPrototypeMethod(t, "writeBool", WriteBool);
-    Nan::SetPrototypeMethod(t, "readBlank", ReadBlank);
-    Nan::SetPrototypeMethod(t, "writeBlank", WriteBlank);
-    Nan::SetPrototypeMethod(t, "readFormula", ReadFormula);
-    Nan::SetPrototypeMethod(t, "writeFormula", WriteFormula);
-    Nan::SetPrototypeMethod(t, "readComment", ReadComment);
-    Nan::SetPrototypeMethod(t, "writeComment", WriteComment);
-    Nan::SetPrototypeMethod(t, "isDate", IsDate);
-    Nan::SetPrototypeMethod(t, "readError", ReadError);
-    Nan::SetPrototypeMethod(t, "colWidth", ColWidth);
-    Nan::SetPrototypeMethod(t, "rowHeight", RowHeight);
-    Nan::SetPrototypeMethod(t, "setCol", SetCol);
-    Nan::SetPrototypeMethod(t, "setRow", SetRow);
-    Nan::SetPrototypeMethod(t, "rowHidden", RowHidden);
-    Nan::SetPrototypeMethod(t, "setRowHidden", SetRowHidden);
-    Nan::SetPrototypeMethod(t, "colHidden", ColHidden);
-    Nan::SetPrototypeMethod(t, "setColHidden", SetColHidden);
-    Nan::SetPrototypeMethod(t, "getMerge", GetMerge);
-    Nan::SetPrototypeMethod(t, "setMerge", SetMerge);
-    Nan::SetPrototypeMethod(t, "delMerge", DelMerge);
-    Nan::SetPrototypeMethod(t, "pictureSize", PictureSize);
-    Nan::SetPrototypeMethod(t, "getPicture", GetPicture);
-    Nan::SetPrototypeMethod(t, "setPicture", SetPicture);
-    Nan::SetPrototypeMethod(t, "setPicture2", SetPicture2);
-    Nan::SetPrototypeMethod(t, "getHorPageBreak", GetHorPageBreak);
-    Nan::SetPrototypeMethod(t, "getHorPageBreakSize", GetHorPageBreakSize);
-    Nan::SetPrototypeMethod(t, "getVerPageBreak", GetVerPageBreak);
-    Nan::SetPrototypeMethod(t, "getVerPageBreakSize", GetVerPageBreakSize);
-    Nan::SetPrototypeMethod(t, "setHorPageBreak", SetHorPageBreak);
-    Nan::SetPrototypeMethod(t, "setVerPageBreak", SetVerPageBreak);
-    Nan::SetPrototypeMethod(t, "split", Split);
-    Nan::SetPrototypeMethod(t, "groupRows", GroupRows);
-    Nan::SetPrototypeMethod(t, "groupCols", GroupCols);
-    Nan::SetPrototypeMethod(t, "groupSummaryBelow", GroupSummaryBelow);
-    Nan::SetPrototypeMethod(t, "setGroupSummaryBelow", SetGroupSummaryBelow);
-    Nan::SetPrototypeMethod(t, "groupSummaryRight", GroupSummaryRight);
-    Nan::SetPrototypeMethod(t, "setGroupSummaryRight", SetGroupSummaryRight);
-    Nan::SetPrototypeMethod(t, "clear", Clear);
-    Nan::SetPrototypeMethod(t, "insertRow", InsertRow);
-    Nan::SetPrototypeMethod(t, "insertRowAsync", InsertRowAsync);
-    Nan::SetPrototypeMethod(t, "insertCol", InsertCol);
-    Nan::SetPrototypeMethod(t, "insertColAsync", InsertColAsync);
-    Nan::SetPrototypeMethod(t, "removeRow", RemoveRow);
-    Nan::SetPrototypeMethod(t, "removeRowAsync", RemoveRowAsync);
-    Nan::SetPrototypeMethod(t, "removeCol", RemoveCol);
-    Nan::SetPrototypeMethod(t, "removeColAsync", RemoveColAsync);
-    Nan::SetPrototypeMethod(t, "copyCell", CopyCell);
-    Nan::SetPrototypeMethod(t, "firstRow", FirstRow);
-    Nan::SetPrototypeMethod(t, "lastRow", LastRow);
-    Nan::SetPrototypeMethod(t, "firstCol", FirstCol);
-    Nan::SetPrototypeMethod(t, "lastCol", LastCol);
-    Nan::SetPrototypeMethod(t, "displayGridlines", DisplayGridlines);
-    Nan::SetPrototypeMethod(t, "setDisplayGridlines", SetDisplayGridlines);
-    Nan::SetPrototypeMethod(t, "printGridlines", PrintGridlines);
-    Nan::SetPrototypeMethod(t, "setPrintGridlines", SetPrintGridlines);
-    Nan::SetPrototypeMethod(t, "zoom", Zoom);
-    Nan::SetPrototypeMethod(t, "setZoom", SetZoom);
-    Nan::SetPrototypeMethod(t, "printZoom", PrintZoom);
-    Nan::SetPrototypeMethod(t, "setPrintZoom", SetPrintZoom);
-    Nan::SetPrototypeMethod(t, "getPrintFit", GetPrintFit);
-    Nan::SetPrototypeMethod(t, "setPrintFit", SetPrintFit);
-    Nan::SetPrototypeMethod(t, "landscape", Landscape);
-    Nan::SetPrototypeMethod(t, "setLandscape", SetLandscape);
-    Nan::SetPrototypeMethod(t, "paper", Paper);
-    Nan::SetPrototypeMethod(t, "setPaper", SetPaper);
-    Nan::SetPrototypeMethod(t, "header", Header);
-    Nan::SetPrototypeMethod(t, "setHeader", SetHeader);
-    Nan::SetPrototypeMethod(t, "headerMargin", HeaderMargin);
-    Nan::SetPrototypeMethod(t, "footer", Footer);
-    Nan::SetPrototypeMethod(t, "setFooter", SetFooter);
-    Nan::SetPrototypeMethod(t, "footerMargin", FooterMargin);
-    Nan::SetPrototypeMethod(t, "hCenter", HCenter);
-    Nan::SetPrototypeMethod(t, "setHCenter", SetHCenter);
-    Nan::SetPrototypeMethod(t, "vCenter", VCenter);
-    Nan::SetPrototypeMethod(t, "setVCenter", SetVCenter);
-    Nan::SetPrototypeMethod(t, "marginLeft", MarginLeft);
-    Nan::SetPrototypeMethod(t, "setMarginLeft", SetMarginLeft);
-    Nan::SetPrototypeMethod(t, "marginRight", MarginRight);
-    Nan::SetPrototypeMethod(t, "setMarginRight", SetMarginRight);
-    Nan::SetPrototypeMethod(t, "marginTop", MarginTop);
-    Nan::SetPrototypeMethod(t, "setMarginTop", SetMarginTop);
-    Nan::SetPrototypeMethod(t, "marginBottom", MarginBottom);
-    Nan::SetPrototypeMethod(t, "setMarginBottom", SetMarginBottom);
-    Nan::SetPrototypeMethod(t, "printRowCol", PrintRowCol);
-    Nan::SetPrototypeMethod(t, "setPrintRowCol", SetPrintRowCol);
-    Nan::SetPrototypeMethod(t, "setPrintRepeatRows", SetPrintRepeatRows);
-    Nan::SetPrototypeMethod(t, "setPrintRepeatCols", SetPrintRepeatCols);
-    Nan::SetPrototypeMethod(t, "setPrintArea", SetPrintArea);
-    Nan::SetPrototypeMethod(t, "clearPrintRepeats", ClearPrintRepeats);
-    Nan::SetPrototypeMethod(t, "clearPrintArea", ClearPrintArea);
-    Nan::SetPrototypeMethod(t, "getNamedRange", GetNamedRange);
-    Nan::SetPrototypeMethod(t, "setNamedRange", SetNamedRange);
-    Nan::SetPrototypeMethod(t, "delNamedRange", DelNamedRange);
-    Nan::SetPrototypeMethod(t, "namedRangeSize", NamedRangeSize);
-    Nan::SetPrototypeMethod(t, "namedRange", NamedRange);
-    Nan::SetPrototypeMethod(t, "name", Name);
-    Nan::SetPrototypeMethod(t, "setName",SetName);
-    Nan::SetPrototypeMethod(t, "protect", Protect);
-    Nan::SetPrototypeMethod(t, "setProtect", SetProtect);
-    Nan::SetPrototypeMethod(t, "rightToLeft", RightToLeft);
-    Nan::SetPrototypeMethod(t, "setRightToLeft", SetRightToLeft);
-    Nan::SetPrototypeMethod(t, "hidden", Hidden);
-    Nan::SetPrototypeMethod(t, "setHidden", SetHidden);
-    Nan::SetPrototypeMethod(t, "getTopLeftView", GetTopLeftView);
-    Nan::SetPrototypeMethod(t, "setTopLeftView", SetTopLeftView);
-    Nan::SetPrototypeMethod(t, "addrToRowCol", AddrToRowCol);
-    Nan::SetPrototypeMethod(t, "rowColToAddr", RowColToAddr);
+    Sheet* that = Unwrap(info.This());
+    ASSERT_THIS(that);
 
-    t->ReadOnlyPrototype();
-    constructor.Reset(t->GetFunction());
+    Local<Value> values[4];
+    if (!ReadCellValues(that, row, col, withFormat, withDate, pool, values)) {
+        return util::ThrowLibxlError(that);
+    }
 
-    NODE_DEFINE_CONSTANT(exports, CELLTYPE_EMPTY);
-    NODE_DEFINE_CONSTANT(exports, CELLTYPE_NUMBER);
-    NODE_DEFINE_CONSTANT(exports, CELLTYPE_STRING);
-    NODE_DEFINE_CONSTANT(exports, CELLTYPE_BOOLEAN);
-    NODE_DEFINE_CONSTANT(exports, CELLTYPE_BLANK);
-    NODE_DEFINE_CONSTANT(exports, CELLTYPE_ERROR);
+    info.GetReturnValue().Set(readCellShape.NewInstance(values));
+}
+
+
+NAN_METHOD(Sheet::ReadCellInto) {
+    Nan::HandleScope scope;
+
+    ArgumentHelper arguments(info);
+
+    int row = arguments.GetInt(0);
+    int col = arguments.GetInt(1);
+    Local<Object> target = arguments.GetObject(2);
+    bool withFormat = arguments.GetBooleanOption(3, "withFormat", false);
+    bool withDate = arguments.GetBooleanOption(3, "withDate", false);
+    StringPool* pool = arguments.GetWrappedOption<StringPool>(3, "pool");
+    ASSERT_ARGUMENTS(arguments);
+
+    Sheet* that = Unwrap(info.This());
+    ASSERT_THIS(that);
+
+    Local<Value> values[4];
+    if (!ReadCellValues(that, row, col, withFormat, withDate, pool, values)) {
+        return util::ThrowLibxlError(that);
+    }
+
+    readCellShape.Assign(target, values);
+
+    info.GetReturnValue().Set(target);
+}
+
+
+NAN_METHOD(Sheet::ReadRange) {
+    Nan::HandleScope scope;
+
+    ArgumentHelper arguments(info);
+
+    int rowFirst    = arguments.GetInt(0),
+        rowLast     = arguments.GetInt(1),
+        colFirst    = arguments.GetInt(2),
+        colLast     = arguments.GetInt(3);
+    bool columns    = arguments.GetBooleanOption(4, "columns", false),
+         formulas   = arguments.GetBooleanOption(4, "formulas", false),
+         external   = arguments.GetBooleanOption(4, "externalStrings", false);
+    StringPool* pool = arguments.GetWrappedOption<StringPool>(4, "pool");
+    ASSERT_ARGUMENTS(arguments);
+
+    if (rowFirst < 0 || colFirst < 0 ||
+        !util::IsValidRange(rowFirst, rowLast, colFirst, colLast))
+    {
+        return Nan::ThrowRangeError("invalid range");
+    }
+
+    if (util::RangeCellCount(rowFirst, rowLast, colFirst, colLast) >
+        util::MAX_RANGE_CELLS)
+    {
+        return Nan::ThrowRangeError("range too large");
+    }
+
+    Sheet* that = Unwrap(info.This());
+    ASSERT_THIS(that);
+
+    RangeSnapshot snapshot(rowFirst, rowLast, colFirst, colLast, formulas);
+    if (!snapshot.Read(that->GetWrapped())) {
+        return util::ThrowLibxlError(that);
+    }
+
+    info.GetReturnValue().Set(columns ?
+        snapshot.ToColumns(pool, external) : snapshot.ToRows(pool, external));
+}
+
+
+NAN_METHOD(Sheet::ReadRangeAsync) {
+    class Worker : public AsyncWorker<Sheet> {
+        public:
+            Worker(Nan::Callback* callback, Local<Object> that, int rowFirst,
+                    int rowLast, int colFirst, int colLast, bool columns,
+                    bool formulas, bool external, StringPool* pool) :
+                AsyncWorker<Sheet>(callback, that),
+                snapshot(rowFirst, rowLast, colFirst, colLast, formulas),
+                columns(columns),
+                external(external),
+                pool(pool)
+            {
+                // Keeps the pool alive until the callback
+                if (pool) SaveToPersistent("pool", pool->handle());
+            }
+
+            virtual void Execute() {
+                if (!snapshot.Read(that->GetWrapped())) {
+                    RaiseLibxlError();
+                }
+            }
+
+            virtual void HandleOKCallback() {
+                Nan::HandleScope scope;
+
+                Local<Value> argv[] = {
+                    Nan::Undefined(),
+                    columns ?
+                        snapshot.ToColumns(pool, external) :
+                        snapshot.ToRows(pool, external)
+                };
+
+                callback->Call(2, argv);
+            }
+
+        private:
+            RangeSnapshot snapshot;
+            bool columns, external;
+            StringPool* pool;
+    };
+
+    Nan::HandleScope scope;
+
+    ArgumentHelper arguments(info);
+
+    // The options argument may be omitted
+    uint8_t callbackPos = info[4]->IsFunction() ? 4 : 5;
+
+    int rowFirst    = arguments.GetInt(0),
+        rowLast     = arguments.GetInt(1),
+        colFirst    = arguments.GetInt(2),
+        colLast     = arguments.GetInt(3);
+    bool columns    = false,
+         formulas   = false,
+         external   = false;
+    StringPool* pool = NULL;
+    if (callbackPos == 5) {
+        columns     = arguments.GetBooleanOption(4, "columns", false);
+        formulas    = arguments.GetBooleanOption(4, "formulas", false);
+        external    = arguments.GetBooleanOption(4, "externalStrings", false);
+        pool        = arguments.GetWrappedOption<StringPool>(4, "pool");
+    }
+    Local<Function> callback = arguments.GetFunction(callbackPos);
+    ASSERT_ARGUMENTS(arguments);
+
+    if (rowFirst < 0 || colFirst < 0 ||
+        !util::IsValidRange(rowFirst, rowLast, colFirst, colLast))
+    {
+        return Nan::ThrowRangeError("invalid range");
+    }
+
+    if (util::RangeCellCount(rowFirst, rowLast, colFirst, colLast) >
+        util::MAX_RANGE_CELLS)
+    {
+        return Nan::ThrowRangeError("range too large");
+    }
+
+    Sheet* that = Unwrap(info.This());
+    ASSERT_THIS_ASYNC(that);
+
+    AsyncQueueWorker(new Worker(new Nan::Callback(callback), info.This(),
+        rowFirst, rowLast, colFirst, colLast, columns, formulas, external,
+        pool));
+
+    info.GetReturnValue().Set(info.This());
+}
+
+
+namespace {
+
+
+// Unwraps an array of formats or nulls. Returns an error message if an
+// entry is neither or belongs to a different book.
+const char* UnwrapFormats(Local<Array> handles, Sheet* sheet,
+    std::vector<libxl::Format*>& formats)
+{
+    formats.assign(handles->Length(), NULL);
+
+    for (uint32_t i = 0; i < handles->Length(); i++) {
+        Local<Value> handle = handles->Get(i);
+        if (handle->IsUndefined() || handle->IsNull()) continue;
+
+        Format* format = Format::Unwrap(handle);
+        if (!format) {
+            return "format or null required in format array";
+        }
+
+        if (!util::IsSameBook(sheet, format)) {
+            return "parent books differ";
+        }
+
+        formats[i] = format->GetWrapped();
+    }
+
+    return NULL;
+}
+
+
+// Cell values of a writeRows batch, converted in a single pass so that the
+// whole batch is validated before anything is written. Types are libxl cell
+// types (CELLTYPE_EMPTY for null and undefined), values hold numbers,
+// booleans and indexes into strings.
+struct RowBatch {
+    std::vector<uint32_t> rowLengths;
+    std::vector<uint8_t> types;
+    std::vector<double> values;
+    std::vector<std::string> strings;
+};
+
+
+// Returns an error message if the batch can not be written
+const char* ReadRowBatch(Local<Array> rows, RowBatch& batch) {
+    uint32_t rowCount = rows->Length();
+
+    batch.rowLengths.reserve(rowCount);
+
+    for (uint32_t i = 0; i < rowCount; i++) {
+        Nan::HandleScope scope;
+
+        Local<Value> rowHandle = rows->Get(i);
+        if (!rowHandle->IsArray()) {
+            return "array of arrays required at position 2";
+        }
+
+        Local<Array> values = rowHandle.As<Array>();
+        uint32_t colCount = values->Length();
+
+        batch.rowLengths.push_back(colCount);
+
+        for (uint32_t j = 0; j < colCount; j++) {
+            Local<Value> value = values->Get(j);
+
+            if (value->IsNumber()) {
+                batch.types.push_back(libxl::CELLTYPE_NUMBER);
+                batch.values.push_back(value->NumberValue());
+            } else if (value->IsString()) {
+                Utf8String str(value);
+
+                batch.types.push_back(libxl::CELLTYPE_STRING);
+                batch.values.push_back(batch.strings.size());
+                batch.strings.push_back(std::string(*str, str.length()));
+            } else if (value->IsBoolean()) {
+                batch.types.push_back(libxl::CELLTYPE_BOOLEAN);
+                batch.values.push_back(value->BooleanValue() ? 1 : 0);
+            } else if (value->IsNull() || value->IsUndefined()) {
+                batch.types.push_back(libxl::CELLTYPE_EMPTY);
+                batch.values.push_back(0);
+            } else {
+                return "cell values must be numbers, strings, booleans or null";
+            }
+        }
+    }
+
+    return NULL;
+}
+
+
+}
+
+
+NAN_METHOD(Sheet::WriteRows) {
+    Nan::HandleScope scope;
+
+    ArgumentHelper arguments(info);
+
+    int row = arguments.GetInt(0),
+        col = arguments.GetInt(1);
+    Local<Array> rows = arguments.GetArray(2);
+    Local<Array> formatHandles = info[3]->IsUndefined() ?
+        Nan::New<Array>() : arguments.GetArray(3);
+    ASSERT_ARGUMENTS(arguments);
+
+    Sheet* that = Unwrap(info.This());
+    ASSERT_THIS(that);
+
+    // Formats and values are validated once for the whole batch, so an
+    // invalid batch leaves the sheet untouched
+    std::vector<libxl::Format*> formats;
+    const char* formatError = UnwrapFormats(formatHandles, that, formats);
+    if (formatError) {
+        return Nan::ThrowTypeError(formatError);
+    }
+
+    RowBatch batch;
+    const char* rowsError = ReadRowBatch(rows, batch);
+    if (rowsError) {
+        return Nan::ThrowTypeError(rowsError);
+    }
+
+    libxl::Sheet* libxlSheet = that->GetWrapped();
+    size_t index = 0;
+
+    for (uint32_t i = 0; i < batch.rowLengths.size(); i++) {
+        for (uint32_t j = 0; j < batch.rowLengths[i]; j++, index++) {
+            libxl::Format* format = j < formats.size() ? formats[j] : NULL;
+            int cellRow = row + i, cellCol = col + j;
+            double value = batch.values[index];
+            bool success = true;
+
+            switch (batch.types[index]) {
+                case libxl::CELLTYPE_NUMBER:
+                    success = libxlSheet->writeNum(cellRow, cellCol, value,
+                        format);
+                    break;
+
+                case libxl::CELLTYPE_STRING:
+                    success = libxlSheet->writeStr(cellRow, cellCol,
+                        batch.strings[static_cast<size_t>(value)].c_str(),
+                        format);
+                    break;
+
+                case libxl::CELLTYPE_BOOLEAN:
+                    success = libxlSheet->writeBool(cellRow, cellCol,
+                        value != 0, format);
+                    break;
+
+                default:
+                    if (format) {
+                        success = libxlSheet->writeBlank(cellRow, cellCol,
+                            format);
+                    }
+                    break;
+            }
+
+            if (!success) {
+                return util::ThrowLibxlError(that);
+            }
+        }
+    }
+
+    info.GetReturnValue().Set(info.This());
+}
+
+
+NAN_METHOD(Sheet::ReadRangeBinary) {
+    Nan::HandleScope scope;
+
+    ArgumentHelper arguments(info);
+
+    int rowFirst    = arguments.GetInt(0),
+        rowLast     = arguments.GetInt(1),
+        colFirst    = arguments.GetInt(2),
+        colLast     = arguments.GetInt(3);
+    ASSERT_ARGUMENTS(arguments);
+
+    if (rowFirst < 0 || colFirst < 0 ||
+        !util::IsValidRange(rowFirst, rowLast, colFirst, colLast))
+    {
+        return Nan::ThrowRangeError("invalid range");
+    }
+
+    if (util::RangeCellCount(rowFirst, rowLast, colFirst, colLast) >
+        util::MAX_RANGE_CELLS)
+    {
+        return Nan::ThrowRangeError("range too large");
+    }
+
+    Sheet* that = Unwrap(info.This());
+    ASSERT_THIS(that);
+
+    RangeSnapshot snapshot(rowFirst, rowLast, colFirst, colLast);
+    if (!snapshot.Read(that->GetWrapped())) {
+        return util::ThrowLibxlError(that);
+    }
+
+    size_t size;
+    if (!snapshot.EncodedSize(size)) {
+        return Nan::ThrowRangeError("range too large to encode");
+    }
+
+    char* buffer = new char[size];
+    snapshot.Encode(buffer);
+
+    info.GetReturnValue().Set(Nan::NewBuffer(buffer, size).ToLocalChecked());
+}
+
+
+NAN_METHOD(Sheet::WriteRangeBinary) {
+    Nan::HandleScope scope;
+
+    ArgumentHelper arguments(info);
+
+    int row = arguments.GetInt(0),
+        col = arguments.GetInt(1);
+    Local<Value> buffer = arguments.GetBuffer(2);
+    ASSERT_ARGUMENTS(arguments);
+
+    Sheet* that = Unwrap(info.This());
+    ASSERT_THIS(that);
+
+    RangeSnapshot snapshot;
+    if (!snapshot.Decode(node::Buffer::Data(buffer), node::Buffer::Length(buffer))) {
+        return Nan::ThrowTypeError("invalid range encoding");
+    }
+
+    if (!snapshot.Write(that->GetWrapped(), row, col)) {
+        return util::ThrowLibxlError(that);
+    }
+
+    info.GetReturnValue().Set(info.This());
+}
+
+
+NAN_METHOD(Sheet::CellTypes) {
+    Nan::HandleScope scope;
+
+    ArgumentHelper arguments(info);
+
+    int rowFirst    = arguments.GetInt(0),
+        rowLast     = arguments.GetInt(1),
+        colFirst    = arguments.GetInt(2),
+        colLast     = arguments.GetInt(3);
+    ASSERT_ARGUMENTS(arguments);
+
+    if (rowFirst < 0 || colFirst < 0 ||
+        !util::IsValidRange(rowFirst, rowLast, colFirst, colLast))
+    {
+        return Nan::ThrowRangeError("invalid range");
+    }
+
+    uint64_t cellCount = util::RangeCellCount(rowFirst, rowLast, colFirst,
+        colLast);
+    if (cellCount > util::MAX_RANGE_CELLS) {
+        return Nan::ThrowRangeError("range too large");
+    }
+
+    Sheet* that = Unwrap(info.This());
+    ASSERT_THIS(that);
+
+    Local<Object> result = util::NewTypedArray("Uint8Array",
+        static_cast<uint32_t>(cellCount));
+    Nan::TypedArrayContents<uint8_t> contents(result);
+    uint8_t* data = *contents;
+
+    libxl::Sheet* libxlSheet = that->GetWrapped();
+
+    for (int row = rowFirst; row <= rowLast; row++) {
+        for (int col = colFirst; col <= colLast; col++) {
+            libxl::CellType cellType = libxlSheet->cellType(row, col);
+            uint8_t entry = cellType & CELLTYPE_MASK;
+
+            if (cellType != libxl::CELLTYPE_EMPTY) {
+                if (libxlSheet->isFormula(row, col)) {
+                    entry |= CELLFLAG_FORMULA;
+                }
+
+                if (cellType == libxl::CELLTYPE_NUMBER &&
+                    libxlSheet->isDate(row, col))
+                {
+                    entry |= CELLFLAG_DATE;
+                }
+            }
+
+            *data++ = entry;
+        }
+    }
+
+    info.GetReturnValue().Set(result);
+}
+
+
+NAN_METHOD(Sheet::ReadNumColumn) {
+    Nan::HandleScope scope;
+
+    ArgumentHelper arguments(info);
+
+    int rowFirst    = arguments.GetInt(0),
+        rowLast     = arguments.GetInt(1),
+        col         = arguments.GetInt(2);
+    Local<Object> target = info[3]->IsUndefined() ?
+        Local<Object>() : arguments.GetFloat64Array(3);
+    ASSERT_ARGUMENTS(arguments);
+
+    if (rowFirst < 0 || col < 0 ||
+        !util::IsValidRange(rowFirst, rowLast, col, col))
+    {
+        return Nan::ThrowRangeError("invalid range");
+    }
+
+    uint64_t cellCount = util::RangeCellCount(rowFirst, rowLast, col, col);
+    if (cellCount > util::MAX_RANGE_CELLS) {
+        return Nan::ThrowRangeError("range too large");
+    }
+
+    Sheet* that = Unwrap(info.This());
+    ASSERT_THIS(that);
+
+    uint32_t length = static_cast<uint32_t>(cellCount);
+    if (target.IsEmpty()) {
+        target = util::NewTypedArray("Float64Array", length);
+    }
+
+    Nan::TypedArrayContents<double> contents(target);
+    if (contents.length() < length) {
+        return Nan::ThrowRangeError("target array too small");
+    }
+
+    libxl::Sheet* libxlSheet = that->GetWrapped();
+    double* data = *contents;
+
+    for (uint32_t i = 0; i < length; i++) {
+        int row = rowFirst + i;
+
+        data[i] = libxlSheet->cellType(row, col) == libxl::CELLTYPE_NUMBER ?
+            libxlSheet->readNum(row, col) :
+            std::numeric_limits<double>::quiet_NaN();
+    }
+
+    info.GetReturnValue().Set(target);
+}
+
+
+NAN_METHOD(Sheet::WriteNumColumn) {
+    Nan::HandleScope scope;
+
+    ArgumentHelper arguments(info);
+
+    int rowFirst = arguments.GetInt(0),
+        col = arguments.GetInt(1);
+    Local<Object> values = arguments.GetFloat64Array(2);
+    Format* format = arguments.GetWrapped<Format>(3, NULL);
+    ASSERT_ARGUMENTS(arguments);
+
+    Nan::TypedArrayContents<double> contents(values);
+    const double* data = *contents;
+    size_t length = contents.length();
+
+    // The column has to fit into the sheet
+    if (rowFirst < 0 || col < 0 || rowFirst >= util::MAX_ROWS ||
+        col >= util::MAX_COLS ||
+        length > static_cast<size_t>(util::MAX_ROWS - rowFirst))
+    {
+        return Nan::ThrowRangeError("invalid range");
+    }
+
+    Sheet* that = Unwrap(info.This());
+    ASSERT_THIS(that);
+    if (format) {
+        ASSERT_SAME_BOOK(that, format);
+    }
+
+    libxl::Sheet* libxlSheet = that->GetWrapped();
+    libxl::Format* libxlFormat = format ? format->GetWrapped() : NULL;
+
+    for (size_t i = 0; i < length; i++) {
+        // NaN marks a hole, mirroring readNumColumn
+        if (data[i] != data[i]) continue;
+
+        if (!libxlSheet->writeNum(rowFirst + i, col, data[i], libxlFormat)) {
+            return util::ThrowLibxlError(that);
+        }
+    }
+
+    info.GetReturnValue().Set(info.This());
+}
+
+
+NAN_METHOD(Sheet::ToArrow) {
+    class Worker : public AsyncWorker<Sheet> {
+        public:
+            Worker(Nan::Callback* callback, Local<Object> that,
+                    libxl::Book* book, int rowFirst, int rowLast, int colFirst,
+                    int colLast, bool headerRow) :
+                AsyncWorker<Sheet>(callback, that),
+                writer(rowFirst, rowLast, colFirst, colLast, headerRow),
+                book(book),
+                buffer(NULL),
+                size(0)
+            {}
+
+            // Frees the data if the result is dropped
+            virtual ~Worker() {
+                delete[] buffer;
+            }
+
+            virtual void Execute() {
+                if (!writer.Write(book, that->GetWrapped())) {
+                    RaiseLibxlError();
+                    return;
+                }
+
+                const std::vector<char>& stream = writer.Stream();
+
+                size = stream.size();
+                buffer = new char[size];
+                memcpy(buffer, &stream[0], size);
+            }
+
+            virtual void HandleOKCallback() {
+                Nan::HandleScope scope;
+
+                Local<Value> argv[] = {
+                    Nan::Undefined(),
+                    Nan::NewBuffer(buffer, size).ToLocalChecked()
+                };
+                buffer = NULL;
+
+                callback->Call(2, argv);
+            }
+
+        private:
+            ArrowWriter writer;
+            libxl::Book* book;
+            char* buffer;
+            size_t size;
+    };
+
+    Nan::HandleScope scope;
+
+    ArgumentHelper arguments(info);
+
+    // Range and options may be omitted
+    uint8_t callbackPos = info[0]->IsFunction() ? 0 :
+        (info[1]->IsFunction() ? 1 : 2);
+
+    bool headerRow = callbackPos == 2 ?
+        arguments.GetBooleanOption(1, "headerRow", false) : false;
+    Local<Function> callback = arguments.GetFunction(callbackPos);
+
+    // Omitted bounds are resolved by the worker, as the book may be busy
+    int rowFirst, rowLast, colFirst, colLast;
+    arguments.GetRange(0, NULL, rowFirst, rowLast, colFirst, colLast);
+    ASSERT_ARGUMENTS(arguments);
+
+    if (!util::IsValidRange(rowFirst, rowLast, colFirst, colLast)) {
+        return Nan::ThrowRangeError("invalid range");
+    }
+
+    Sheet* that = Unwrap(info.This());
+    ASSERT_THIS_ASYNC(that);
+
+    AsyncQueueWorker(new Worker(new Nan::Callback(callback), info.This(),
+        util::UnwrapBook(that), rowFirst, rowLast, colFirst, colLast,
+        headerRow));
+
+    info.GetReturnValue().Set(info.This());
+}
+
+
+NAN_METHOD(Sheet::FromArrow) {
+    class Worker : public AsyncWorker<Sheet> {
+        public:
+            Worker(Nan::Callback* callback, Local<Object> that,
+                    libxl::Book* book, Local<Value> buffer, int row, int col,
+                    bool headerRow) :
+                AsyncWorker<Sheet>(callback, that),
+                reader(row, col, headerRow),
+                book(book),
+                buffer(buffer)
+            {}
+
+            virtual void Execute() {
+                if (reader.Read(book, that->GetWrapped(), *buffer,
+                    buffer.GetSize()))
+                {
+                    return;
+                }
+
+                if (reader.ErrorMessage()) {
+                    SetErrorMessage(reader.ErrorMessage());
+                } else {
+                    RaiseLibxlError();
+                }
+            }
+
+        private:
+            ArrowReader reader;
+            libxl::Book* book;
+            BufferCopy buffer;
+    };
+
+    Nan::HandleScope scope;
+
+    ArgumentHelper arguments(info);
+
+    // The options argument may be omitted
+    uint8_t callbackPos = info[3]->IsFunction() ? 3 : 4;
+
+    Local<Value> buffer = arguments.GetBuffer(0);
+    int row         = arguments.GetInt(1),
+        col         = arguments.GetInt(2);
+    bool headerRow  = callbackPos == 4 ?
+        arguments.GetBooleanOption(3, "headerRow", false) : false;
+    Local<Function> callback = arguments.GetFunction(callbackPos);
+    ASSERT_ARGUMENTS(arguments);
+
+    if (row < 0 || col < 0) {
+        return Nan::ThrowRangeError("invalid range");
+    }
+
+    Sheet* that = Unwrap(info.This());
+    ASSERT_THIS_ASYNC(that);
+
+    AsyncQueueWorker(new Worker(new Nan::Callback(callback), info.This(),
+        util::UnwrapBook(that), buffer, row, col, headerRow));
+
+    info.GetReturnValue().Set(info.This());
+}
+
+
+NAN_METHOD(Sheet::ToCSV) {
+    class Worker : public AsyncWorker<Sheet> {
+        public:
+            Worker(Nan::Callback* callback, Local<Object> that,
+                    libxl::Book* book, int rowFirst, int rowLast, int colFirst,
+                    int colLast, char delimiter, char quote,
+                    const std::string& path) :
+                AsyncWorker<Sheet>(callback, that),
+                writer(rowFirst, rowLast, colFirst, colLast, delimiter, quote),
+                book(book),
+                path(path),
+                buffer(NULL),
+                size(0)
+            {}
+
+            // Frees the data if the result is dropped
+            virtual ~Worker() {
+                delete[] buffer;
+            }
+
+            virtual void Execute() {
+                if (!writer.Write(book, that->GetWrapped(), path)) {
+                    if (writer.ErrorMessage()) {
+                        SetErrorMessage(writer.ErrorMessage());
+                    } else {
+                        RaiseLibxlError();
+                    }
+
+                    return;
+                }
+
+                if (path.empty()) {
+                    const std::vector<char>& data = writer.Data();
+
+                    size = data.size();
+                    buffer = new char[size];
+                    if (size > 0) memcpy(buffer, &data[0], size);
+                }
+            }
+
+            virtual void HandleOKCallback() {
+                Nan::HandleScope scope;
+
+                if (!path.empty()) {
+                    return Nan::AsyncWorker::HandleOKCallback();
+                }
+
+                Local<Value> argv[] = {
+                    Nan::Undefined(),
+                    Nan::NewBuffer(buffer, size).ToLocalChecked()
+                };
+                buffer = NULL;
+
+                callback->Call(2, argv);
+            }
+
+        private:
+            CsvWriter writer;
+            libxl::Book* book;
+            std::string path;
+            char* buffer;
+            size_t size;
+    };
+
+    Nan::HandleScope scope;
+
+    ArgumentHelper arguments(info);
+
+    // Target and options may be omitted
+    uint8_t callbackPos = info[0]->IsFunction() ? 0 :
+        (info[1]->IsFunction() ? 1 : 2);
+
+    std::string path;
+    if (callbackPos > 0 && !info[0]->IsUndefined() && !info[0]->IsNull()) {
+        path = *Utf8String(arguments.GetString(0));
+    }
+
+    Local<Value> delimiter = Nan::New<String>(",").ToLocalChecked(),
+        quote = Nan::New<String>("\"").ToLocalChecked();
+    if (callbackPos == 2) {
+        delimiter   = arguments.GetStringOption(1, "delimiter", ",");
+        quote       = arguments.GetStringOption(1, "quote", "\"");
+    }
+    Local<Function> callback = arguments.GetFunction(callbackPos);
+
+    // Omitted bounds are resolved by the worker, as the book may be busy
+    int rowFirst, rowLast, colFirst, colLast;
+    arguments.GetRange(1, "range", rowFirst, rowLast, colFirst, colLast);
+    ASSERT_ARGUMENTS(arguments);
+
+    Sheet* that = Unwrap(info.This());
+    ASSERT_THIS_ASYNC(that);
+
+    Utf8String delimiterChars(delimiter), quoteChars(quote);
+    if (delimiterChars.length() != 1 || quoteChars.length() != 1 ||
+        **delimiterChars == **quoteChars)
+    {
+        return Nan::ThrowTypeError(
+            "delimiter and quote must be distinct single characters");
+    }
+
+    if (!util::IsValidRange(rowFirst, rowLast, colFirst, colLast)) {
+        return Nan::ThrowRangeError("invalid range");
+    }
+
+    AsyncQueueWorker(new Worker(new Nan::Callback(callback), info.This(),
+        util::UnwrapBook(that), rowFirst, rowLast, colFirst, colLast,
+        **delimiterChars, **quoteChars, path));
+
+    info.GetReturnValue().Set(info.This());
+}
+
+
+NAN_METHOD(Sheet::FromCSV) {
+    class Worker : public AsyncWorker<Sheet> {
+        public:
+            Worker(Nan::Callback* callback, Local<Object> that,
+                    libxl::Book* book, Local<Value> source, int row, int col,
+                    char delimiter, char quote, bool inferTypes,
+                    const std::vector<libxl::Format*>& formats) :
+                AsyncWorker<Sheet>(callback, that),
+                reader(row, col, delimiter, quote, inferTypes, formats),
+                book(book),
+                buffer(NULL)
+            {
+                if (source->IsString()) {
+                    path = *Utf8String(source);
+                } else {
+                    buffer = new BufferCopy(source);
+                }
+            }
+
+            virtual ~Worker() {
+                delete buffer;
+            }
+
+            virtual void Execute() {
+                bool success = buffer ?
+                    reader.Read(book, that->GetWrapped(), **buffer,
+                        buffer->GetSize()) :
+                    reader.ReadFile(book, that->GetWrapped(), path);
+
+                if (success) return;
+
+                if (reader.ErrorMessage()) {
+                    SetErrorMessage(reader.ErrorMessage());
+                } else {
+                    RaiseLibxlError();
+                }
+            }
+
+        private:
+            CsvReader reader;
+            libxl::Book* book;
+            std::string path;
+            BufferCopy* buffer;
+    };
+
+    Nan::HandleScope scope;
+
+    ArgumentHelper arguments(info);
+
+    // The options argument may be omitted
+    uint8_t callbackPos = info[1]->IsFunction() ? 1 : 2;
+
+    Local<Value> source = node::Buffer::HasInstance(info[0]) ?
+        info[0] : arguments.GetString(0);
+    int row = 0, col = 0;
+    bool inferTypes = true;
+    Local<Value> delimiter = Nan::New<String>(",").ToLocalChecked(),
+        quote = Nan::New<String>("\"").ToLocalChecked(),
+        formatHandles = Nan::Undefined();
+    if (callbackPos == 2) {
+        row         = arguments.GetIntOption(1, "row", 0);
+        col         = arguments.GetIntOption(1, "col", 0);
+        delimiter   = arguments.GetStringOption(1, "delimiter", ",");
+        quote       = arguments.GetStringOption(1, "quote", "\"");
+        inferTypes  = arguments.GetBooleanOption(1, "inferTypes", true);
+        formatHandles = arguments.GetOption(1, "formats");
+    }
+    Local<Function> callback = arguments.GetFunction(callbackPos);
+    ASSERT_ARGUMENTS(arguments);
+
+    Utf8String delimiterChars(delimiter), quoteChars(quote);
+    if (delimiterChars.length() != 1 || quoteChars.length() != 1 ||
+        **delimiterChars == **quoteChars)
+    {
+        return Nan::ThrowTypeError(
+            "delimiter and quote must be distinct single characters");
+    }
+
+    if (!formatHandles->IsUndefined() && !formatHandles->IsArray()) {
+        return Nan::ThrowTypeError("array required for option formats");
+    }
+
+    if (row < 0 || col < 0) {
+        return Nan::ThrowRangeError("invalid range");
+    }
+
+    Sheet* that = Unwrap(info.This());
+    ASSERT_THIS_ASYNC(that);
+
+    std::vector<libxl::Format*> formats;
+    if (formatHandles->IsArray()) {
+        const char* formatError = UnwrapFormats(formatHandles.As<Array>(),
+            that, formats);
+
+        if (formatError) {
+            return Nan::ThrowTypeError(formatError);
+        }
+    }
+
+    AsyncQueueWorker(new Worker(new Nan::Callback(callback), info.This(),
+        util::UnwrapBook(that), source, row, col, **delimiterChars,
+        **quoteChars, inferTypes, formats));
+
+    info.GetReturnValue().Set(info.This());
+}
+
+
+NAN_METHOD(Sheet::CancelAsync) {
+    Nan::HandleScope scope;
+
+    ArgumentHelper arguments(info);
+
+    Local<Function> callback = arguments.GetFunction(0);
+    ASSERT_ARGUMENTS(arguments);
+
+    Sheet* that = Unwrap(info.This());
+    ASSERT_THIS_ASYNC(that);
+
+    info.GetReturnValue().Set(Nan::New<Boolean>(
+        that->GetBook()->CancelAsync(callback)));
+}
+
+
+NAN_METHOD(Sheet::SetAsyncPriority) {
+    Nan::HandleScope scope;
+
+    ArgumentHelper arguments(info);
+
+    int priority = arguments.GetInt(0);
+    ASSERT_ARGUMENTS(arguments);
+
+    if (priority < 0 || priority >= PRIORITY_COUNT) {
+        return Nan::ThrowRangeError("invalid priority");
+    }
+
+    Sheet* that = Unwrap(info.This());
+    ASSERT_THIS_ASYNC(that);
+
+    that->GetBook()->SetAsyncPriority(priority);
+
+    info.GetReturnValue().Set(info.This());
+}
+
+
+NAN_METHOD(Sheet::AsyncPriority) {
+    Nan::HandleScope scope;
+
+    Sheet* that = Unwrap(info.This());
+    ASSERT_THIS_ASYNC(that);
+
+    info.GetReturnValue().Set(Nan::New<Integer>(
+        that->GetBook()->GetAsyncPriority()));
+}
+
+
+// Init
+
+
+void Sheet::Initialize(Handle<Object> exports) {
+    using namespace libxl;
+
+    Nan::HandleScope scope;
+
+    Local<FunctionTemplate> t = Nan::New<FunctionTemplate>(util::StubConstructor);
+    t->SetClassName(Nan::New<String>("Sheet").ToLocalChecked());
+    t->InstanceTemplate()->SetInternalFieldCount(1);
+
+    BookWrapper::Initialize<Sheet>(t);
+
+    Nan::SetPrototypeMethod(t, "cellType", CellType);
+    Nan::SetPrototypeMethod(t, "isFormula", IsFormula);
+    Nan::SetPrototypeMethod(t, "cellFormat", CellFormat);
+    Nan::SetPrototypeMethod(t, "setCellFormat", SetCellFormat);
+    Nan::SetPrototypeMethod(t, "readStr", ReadStr);
+    Nan::SetPrototypeMethod(t, "readString", ReadStr);
+    Nan::SetPrototypeMethod(t, "writeString", WriteStr);
+    Nan::SetPrototypeMethod(t, "writeStr", WriteStr);
+    Nan::SetPrototypeMethod(t, "readNum", ReadNum);
+    Nan::SetPrototypeMethod(t, "writeNum", WriteNum);
+    Nan::SetPrototypeMethod(t, "readBool", ReadBool);
+    Nan::SetPrototypeMethod(t, "writeBool", WriteBool);
+    Nan::SetPrototypeMethod(t, "readBlank", ReadBlank);
+    Nan::SetPrototypeMethod(t, "writeBlank", WriteBlank);
+    Nan::SetPrototypeMethod(t, "readFormula", ReadFormula);
+    Nan::SetPrototypeMethod(t, "writeFormula", WriteFormula);
+    Nan::SetPrototypeMethod(t, "readComment", ReadComment);
+    Nan::SetPrototypeMethod(t, "writeComment", WriteComment);
+    Nan::SetPrototypeMethod(t, "isDate", IsDate);
+    Nan::SetPrototypeMethod(t, "readError", ReadError);
+    Nan::SetPrototypeMethod(t, "colWidth", ColWidth);
+    Nan::SetPrototypeMethod(t, "rowHeight", RowHeight);
+    Nan::SetPrototypeMethod(t, "setCol", SetCol);
+    Nan::SetPrototypeMethod(t, "setRow", SetRow);
+    Nan::SetPrototypeMethod(t, "rowHidden", RowHidden);
+    Nan::SetPrototypeMethod(t, "setRowHidden", SetRowHidden);
+    Nan::SetPrototypeMethod(t, "colHidden", ColHidden);
+    Nan::SetPrototypeMethod(t, "setColHidden", SetColHidden);
+    Nan::SetPrototypeMethod(t, "getMerge", GetMerge);
+    Nan::SetPrototypeMethod(t, "setMerge", SetMerge);
+    Nan::SetPrototypeMethod(t, "delMerge", DelMerge);
+    Nan::SetPrototypeMethod(t, "pictureSize", PictureSize);
+    Nan::SetPrototypeMethod(t, "getPicture", GetPicture);
+    Nan::SetPrototypeMethod(t, "setPicture", SetPicture);
+    Nan::SetPrototypeMethod(t, "setPicture2", SetPicture2);
+    Nan::SetPrototypeMethod(t, "getHorPageBreak", GetHorPageBreak);
+    Nan::SetPrototypeMethod(t, "getHorPageBreakSize", GetHorPageBreakSize);
+    Nan::SetPrototypeMethod(t, "getVerPageBreak", GetVerPageBreak);
+    Nan::SetPrototypeMethod(t, "getVerPageBreakSize", GetVerPageBreakSize);
+    Nan::SetPrototypeMethod(t, "setHorPageBreak", SetHorPageBreak);
+    Nan::SetPrototypeMethod(t, "setVerPageBreak", SetVerPageBreak);
+    Nan::SetPrototypeMethod(t, "split", Split);
+    Nan::SetPrototypeMethod(t, "groupRows", GroupRows);
+    Nan::SetPrototypeMethod(t, "groupCols", GroupCols);
+    Nan::SetPrototypeMethod(t, "groupSummaryBelow", GroupSummaryBelow);
+    Nan::SetPrototypeMethod(t, "setGroupSummaryBelow", SetGroupSummaryBelow);
+    Nan::SetPrototypeMethod(t, "groupSummaryRight", GroupSummaryRight);
+    Nan::SetPrototypeMethod(t, "setGroupSummaryRight", SetGroupSummaryRight);
+    Nan::SetPrototypeMethod(t, "clear", Clear);
+    Nan::SetPrototypeMethod(t, "insertRow", InsertRow);
+    Nan::SetPrototypeMethod(t, "insertRowAsync", InsertRowAsync);
+    Nan::SetPrototypeMethod(t, "insertCol", InsertCol);
+    Nan::SetPrototypeMethod(t, "insertColAsync", InsertColAsync);
+    Nan::SetPrototypeMethod(t, "removeRow", RemoveRow);
+    Nan::SetPrototypeMethod(t, "removeRowAsync", RemoveRowAsync);
+    Nan::SetPrototypeMethod(t, "removeCol", RemoveCol);
+    Nan::SetPrototypeMethod(t, "removeColAsync", RemoveColAsync);
+    Nan::SetPrototypeMethod(t, "copyCell", CopyCell);
+    Nan::SetPrototypeMethod(t, "firstRow", FirstRow);
+    Nan::SetPrototypeMethod(t, "lastRow", LastRow);
+    Nan::SetPrototypeMethod(t, "firstCol", FirstCol);
+    Nan::SetPrototypeMethod(t, "lastCol", LastCol);
+    Nan::SetPrototypeMethod(t, "displayGridlines", DisplayGridlines);
+    Nan::SetPrototypeMethod(t, "setDisplayGridlines", SetDisplayGridlines);
+    Nan::SetPrototypeMethod(t, "printGridlines", PrintGridlines);
+    Nan::SetPrototypeMethod(t, "setPrintGridlines", SetPrintGridlines);
+    Nan::SetPrototypeMethod(t, "zoom", Zoom);
+    Nan::SetPrototypeMethod(t, "setZoom", SetZoom);
+    Nan::SetPrototypeMethod(t, "printZoom", PrintZoom);
+    Nan::SetPrototypeMethod(t, "setPrintZoom", SetPrintZoom);
+    Nan::SetPrototypeMethod(t, "getPrintFit", GetPrintFit);
+    Nan::SetPrototypeMethod(t, "setPrintFit", SetPrintFit);
+    Nan::SetPrototypeMethod(t, "landscape", Landscape);
+    Nan::SetPrototypeMethod(t, "setLandscape", SetLandscape);
+    Nan::SetPrototypeMethod(t, "paper", Paper);
+    Nan::SetPrototypeMethod(t, "setPaper", SetPaper);
+    Nan::SetPrototypeMethod(t, "header", Header);
+    Nan::SetPrototypeMethod(t, "setHeader", SetHeader);
+    Nan::SetPrototypeMethod(t, "headerMargin", HeaderMargin);
+    Nan::SetPrototypeMethod(t, "footer", Footer);
+    Nan::SetPrototypeMethod(t, "setFooter", SetFooter);
+    Nan::SetPrototypeMethod(t, "footerMargin", FooterMargin);
+    Nan::SetPrototypeMethod(t, "hCenter", HCenter);
+    Nan::SetPrototypeMethod(t, "setHCenter", SetHCenter);
+    Nan::SetPrototypeMethod(t, "vCenter", VCenter);
+    Nan::SetPrototypeMethod(t, "setVCenter", SetVCenter);
+    Nan::SetPrototypeMethod(t, "marginLeft", MarginLeft);
+    Nan::SetPrototypeMethod(t, "setMarginLeft", SetMarginLeft);
+    Nan::SetPrototypeMethod(t, "marginRight", MarginRight);
+    Nan::SetPrototypeMethod(t, "setMarginRight", SetMarginRight);
+    Nan::SetPrototypeMethod(t, "marginTop", MarginTop);
+    Nan::SetPrototypeMethod(t, "setMarginTop", SetMarginTop);
+    Nan::SetPrototypeMethod(t, "marginBottom", MarginBottom);
+    Nan::SetPrototypeMethod(t, "setMarginBottom", SetMarginBottom);
+    Nan::SetPrototypeMethod(t, "printRowCol", PrintRowCol);
+    Nan::SetPrototypeMethod(t, "setPrintRowCol", SetPrintRowCol);
+    Nan::SetPrototypeMethod(t, "setPrintRepeatRows", SetPrintRepeatRows);
+    Nan::SetPrototypeMethod(t, "setPrintRepeatCols", SetPrintRepeatCols);
+    Nan::SetPrototypeMethod(t, "setPrintArea", SetPrintArea);
+    Nan::SetPrototypeMethod(t, "clearPrintRepeats", ClearPrintRepeats);
+    Nan::SetPrototypeMethod(t, "clearPrintArea", ClearPrintArea);
+    Nan::SetPrototypeMethod(t, "getNamedRange", GetNamedRange);
+    Nan::SetPrototypeMethod(t, "setNamedRange", SetNamedRange);
+    Nan::SetPrototypeMethod(t, "delNamedRange", DelNamedRange);
+    Nan::SetPrototypeMethod(t, "namedRangeSize", NamedRangeSize);
+    Nan::SetPrototypeMethod(t, "namedRange", NamedRange);
+    Nan::SetPrototypeMethod(t, "name", Name);
+    Nan::SetPrototypeMethod(t, "setName",SetName);
+    Nan::SetPrototypeMethod(t, "protect", Protect);
+    Nan::SetPrototypeMethod(t, "setProtect", SetProtect);
+    Nan::SetPrototypeMethod(t, "rightToLeft", RightToLeft);
+    Nan::SetPrototypeMethod(t, "setRightToLeft", SetRightToLeft);
+    Nan::SetPrototypeMethod(t, "hidden", Hidden);
+    Nan::SetPrototypeMethod(t, "setHidden", SetHidden);
+    Nan::SetPrototypeMethod(t, "getTopLeftView", GetTopLeftView);
+    Nan::SetPrototypeMethod(t, "setTopLeftView", SetTopLeftView);
+    Nan::SetPrototypeMethod(t, "addrToRowCol", AddrToRowCol);
+    Nan::SetPrototypeMethod(t, "rowColToAddr", RowColToAddr);
+    Nan::SetPrototypeMethod(t, "readCell", ReadCell);
+    Nan::SetPrototypeMethod(t, "readCellInto", ReadCellInto);
+    Nan::SetPrototypeMethod(t, "readRange", ReadRange);
+    Nan::SetPrototypeMethod(t, "readRangeAsync", ReadRangeAsync);
+    Nan::SetPrototypeMethod(t, "writeRows", WriteRows);
+    Nan::SetPrototypeMethod(t, "readRangeBinary", ReadRangeBinary);
+    Nan::SetPrototypeMethod(t, "writeRangeBinary", WriteRangeBinary);
+    Nan::SetPrototypeMethod(t, "cellTypes", CellTypes);
+    Nan::SetPrototypeMethod(t, "readNumColumn", ReadNumColumn);
+    Nan::SetPrototypeMethod(t, "writeNumColumn", WriteNumColumn);
+    Nan::SetPrototypeMethod(t, "toArrow", ToArrow);
+    Nan::SetPrototypeMethod(t, "fromArrow", FromArrow);
+    Nan::SetPrototypeMethod(t, "toCSV", ToCSV);
+    Nan::SetPrototypeMethod(t, "fromCSV", FromCSV);
+    Nan::SetPrototypeMethod(t, "cancelAsync", CancelAsync);
+    Nan::SetPrototypeMethod(t, "setAsyncPriority", SetAsyncPriority);
+    Nan::SetPrototypeMethod(t, "asyncPriority", AsyncPriority);
+
+    t->ReadOnlyPrototype();
+    constructorTemplate.Reset(t);
+    constructor.Reset(t->GetFunction());
+    exports->Set(Nan::New<String>("Sheet").ToLocalChecked(), Nan::New(constructor));
+
+    NODE_DEFINE_CONSTANT(exports, CELLTYPE_EMPTY);
+    NODE_DEFINE_CONSTANT(exports, CELLTYPE_NUMBER);
+    NODE_DEFINE_CONSTANT(exports, CELLTYPE_STRING);
+    NODE_DEFINE_CONSTANT(exports, CELLTYPE_BOOLEAN);
+    NODE_DEFINE_CONSTANT(exports, CELLTYPE_BLANK);
+    NODE_DEFINE_CONSTANT(exports, CELLTYPE_ERROR);
+
+    NODE_DEFINE_CONSTANT(exports, CELLTYPE_MASK);
+    NODE_DEFINE_CONSTANT(exports, CELLFLAG_FORMULA);
+    NODE_DEFINE_CONSTANT(exports, CELLFLAG_DATE);
 
     NODE_DEFINE_CONSTANT(exports, ERRORTYPE_NULL);
     NODE_DEFINE_CONSTANT(exports, ERRORTYPE_DIV_0);
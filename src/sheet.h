@@ -32,12 +32,21 @@
 namespace node_libxl {
 
 
+// Layout of the entries returned by Sheet::CellTypes
+enum {
+    CELLTYPE_MASK       = 0x0F,
+    CELLFLAG_FORMULA    = 0x10,
+    CELLFLAG_DATE       = 0x20
+};
+
+
 class Sheet : public Wrapper<libxl::Sheet> , public BookWrapper
 
 {
     public:
 
         Sheet(libxl::Sheet* sheet, v8::Local<v8::Value> book);
+        ~Sheet();
 
         static void Initialize(v8::Handle<v8::Object> exports);
         
@@ -168,6 +177,23 @@ class Sheet : public Wrapper<libxl::Sheet> , public BookWrapper
         static NAN_METHOD(SetTopLeftView);
         static NAN_METHOD(AddrToRowCol);
         static NAN_METHOD(RowColToAddr);
+        static NAN_METHOD(ReadCell);
+        static NAN_METHOD(ReadCellInto);
+        static NAN_METHOD(ReadRange);
+        static NAN_METHOD(ReadRangeAsync);
+        static NAN_METHOD(WriteRows);
+        static NAN_METHOD(ReadRangeBinary);
+        static NAN_METHOD(WriteRangeBinary);
+        static NAN_METHOD(CellTypes);
+        static NAN_METHOD(ReadNumColumn);
+        static NAN_METHOD(WriteNumColumn);
+        static NAN_METHOD(ToArrow);
+        static NAN_METHOD(FromArrow);
+        static NAN_METHOD(ToCSV);
+        static NAN_METHOD(FromCSV);
+        static NAN_METHOD(CancelAsync);
+        static NAN_METHOD(SetAsyncPriority);
+        static NAN_METHOD(AsyncPriority);
 
     private:
 
@@ -25,26 +25,34 @@
 #include "string_copy.h"
 #include <cstring>
 
+#include "utf8_string.h"
+
 using namespace v8;
 
 namespace node_libxl {
 
 StringCopy::StringCopy(String::Utf8Value& utf8Value) {
-    str = new char[strlen(*utf8Value) + 1];
-    strcpy(str, *utf8Value);
+    Assign(*utf8Value, utf8Value.length());
 }
 
 
 StringCopy::StringCopy(Handle<Value> value) {
-    String::Utf8Value utf8Value(value);
+    Utf8String utf8Value(value);
 
-    str = new char[strlen(*utf8Value) + 1];
-    strcpy(str, *utf8Value);
+    Assign(*utf8Value, utf8Value.length());
 }
 
 
 StringCopy::~StringCopy() {
-    delete[] str;
+    if (str != inlineBuffer) delete[] str;
+}
+
+
+void StringCopy::Assign(const char* value, size_t length) {
+    str = length < INLINE_SIZE ? inlineBuffer : new char[length + 1];
+
+    memcpy(str, value, length);
+    str[length] = '\0';
 }
 
 
@@ -44,7 +44,13 @@ class StringCopy {
        
         StringCopy(const StringCopy&);
         const StringCopy& operator=(const StringCopy&);
-        
+
+        // Short strings (file names etc.) are kept inline
+        static const size_t INLINE_SIZE = 64;
+
+        void Assign(const char* value, size_t length);
+
+        char inlineBuffer[INLINE_SIZE];
         char* str;
 };
 
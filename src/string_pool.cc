@@ -0,0 +1,145 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 Christian Speckner <cnspeckn@googlemail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "string_pool.h"
+
+#include "util.h"
+
+using namespace v8;
+
+namespace node_libxl {
+
+
+Nan::Persistent<Function> StringPool::constructor;
+Nan::Persistent<FunctionTemplate> StringPool::constructorTemplate;
+
+
+// Lifecycle
+
+
+StringPool::StringPool() {
+    strings.Reset(Nan::New<Array>());
+}
+
+
+StringPool::~StringPool() {
+    strings.Reset();
+}
+
+
+StringPool* StringPool::Unwrap(Local<Value> object) {
+    if (!object->IsObject() ||
+        !Nan::New(constructorTemplate)->HasInstance(object))
+    {
+        return NULL;
+    }
+
+    return Nan::ObjectWrap::Unwrap<StringPool>(object.As<Object>());
+}
+
+
+Local<String> StringPool::Get(const char* data, size_t length) {
+    Nan::EscapableHandleScope scope;
+
+    Local<Array> pooled = Nan::New(strings);
+
+    std::pair<StringIndex::iterator, bool> entry = index.insert(
+        StringIndex::value_type(std::string(data, length), pooled->Length()));
+
+    if (!entry.second) {
+        return scope.Escape(pooled->Get(entry.first->second).As<String>());
+    }
+
+    Local<String> value = Nan::New<String>(data, static_cast<int>(length))
+        .ToLocalChecked();
+    pooled->Set(entry.first->second, value);
+
+    return scope.Escape(value);
+}
+
+
+// Wrappers
+
+
+NAN_METHOD(StringPool::New) {
+    Nan::HandleScope scope;
+
+    if (!info.IsConstructCall()) {
+        return info.GetReturnValue().Set(
+            util::ProxyConstructor(Nan::New(constructor), info));
+    }
+
+    StringPool* pool = new StringPool();
+    pool->Wrap(info.This());
+
+    info.GetReturnValue().Set(info.This());
+}
+
+
+NAN_METHOD(StringPool::Size) {
+    Nan::HandleScope scope;
+
+    StringPool* that = Unwrap(info.This());
+    if (!that) return Nan::ThrowTypeError("invalid scope");
+
+    info.GetReturnValue().Set(Nan::New<Integer>(
+        static_cast<uint32_t>(that->index.size())));
+}
+
+
+NAN_METHOD(StringPool::Clear) {
+    Nan::HandleScope scope;
+
+    StringPool* that = Unwrap(info.This());
+    if (!that) return Nan::ThrowTypeError("invalid scope");
+
+    that->index.clear();
+    that->strings.Reset(Nan::New<Array>());
+
+    info.GetReturnValue().Set(info.This());
+}
+
+
+// Init
+
+
+void StringPool::Initialize(Handle<Object> exports) {
+    Nan::HandleScope scope;
+
+    Local<FunctionTemplate> t = Nan::New<FunctionTemplate>(New);
+    t->SetClassName(Nan::New<String>("StringPool").ToLocalChecked());
+    t->InstanceTemplate()->SetInternalFieldCount(1);
+
+    Nan::SetPrototypeMethod(t, "size", Size);
+    Nan::SetPrototypeMethod(t, "clear", Clear);
+
+    t->ReadOnlyPrototype();
+    constructorTemplate.Reset(t);
+    constructor.Reset(t->GetFunction());
+    exports->Set(Nan::New<String>("StringPool").ToLocalChecked(),
+        Nan::New(constructor));
+}
+
+
+}
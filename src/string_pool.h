@@ -0,0 +1,76 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 Christian Speckner <cnspeckn@googlemail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef BINDINGS_STRING_POOL_H
+#define BINDINGS_STRING_POOL_H
+
+#include <map>
+#include <string>
+
+#include "common.h"
+
+namespace node_libxl {
+
+
+// Interns strings read from sheets, so that repeated values (e.g. category
+// labels) share a single JS string. Exposed as xl.StringPool and passed to
+// the readers via the `pool` option, the pool keeps its strings alive until
+// it is cleared or collected.
+class StringPool : public Nan::ObjectWrap {
+    public:
+
+        static void Initialize(v8::Handle<v8::Object> exports);
+
+        // Returns NULL if the object is not a string pool
+        static StringPool* Unwrap(v8::Local<v8::Value> object);
+
+        v8::Local<v8::String> Get(const char* data, size_t length);
+
+    protected:
+
+        static NAN_METHOD(New);
+        static NAN_METHOD(Size);
+        static NAN_METHOD(Clear);
+
+    private:
+
+        typedef std::map<std::string, uint32_t> StringIndex;
+
+        StringPool();
+        ~StringPool();
+
+        StringIndex index;
+        Nan::Persistent<v8::Array> strings;
+
+        static Nan::Persistent<v8::Function> constructor;
+        static Nan::Persistent<v8::FunctionTemplate> constructorTemplate;
+
+        StringPool(const StringPool&);
+        const StringPool& operator=(const StringPool&);
+};
+
+
+}
+
+#endif // BINDINGS_STRING_POOL_H
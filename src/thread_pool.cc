@@ -0,0 +1,272 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 Christian Speckner <cnspeckn@googlemail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+#include <vector>
+
+#include "argument_helper.h"
+#include "assert.h"
+
+using namespace v8;
+
+namespace node_libxl {
+
+
+const unsigned ThreadPool::DEFAULT_SIZE;
+const unsigned ThreadPool::MAX_SIZE;
+const uint64_t ThreadPool::AGING_INTERVAL;
+
+
+namespace {
+
+
+uv_mutex_t mutex;
+uv_cond_t workAvailable;
+uv_async_t completion;
+
+struct PendingWorker {
+    Nan::AsyncWorker* worker;
+    uint64_t queuedAt;
+};
+
+// Guarded by mutex
+std::deque<PendingWorker> pendingWorkers[PRIORITY_COUNT];
+size_t pendingCount = 0;
+std::deque<Nan::AsyncWorker*> completedWorkers;
+std::vector<uv_thread_t*> retiredThreads;
+unsigned poolSize = ThreadPool::DEFAULT_SIZE;
+unsigned threadCount = 0;
+
+// Queued but not yet completed workers, main thread only. The completion
+// handle keeps the loop alive while there are any.
+size_t outstandingWorkers = 0;
+
+
+unsigned DefaultSize() {
+    const char* value = getenv("NODE_LIBXL_THREADPOOL_SIZE");
+    int size = value ? atoi(value) : 0;
+
+    if (size <= 0) return ThreadPool::DEFAULT_SIZE;
+
+    return std::min(static_cast<unsigned>(size), ThreadPool::MAX_SIZE);
+}
+
+
+// Must be called with the mutex held and pendingCount > 0
+Nan::AsyncWorker* PopPendingWorker() {
+    uint64_t now = uv_hrtime();
+    int best = -1;
+    double bestRank = 0;
+
+    for (int priority = 0; priority < PRIORITY_COUNT; priority++) {
+        if (pendingWorkers[priority].empty()) continue;
+
+        double waited = static_cast<double>(
+            now - pendingWorkers[priority].front().queuedAt);
+        double rank = priority - waited / ThreadPool::AGING_INTERVAL;
+
+        if (best < 0 || rank < bestRank) {
+            best = priority;
+            bestRank = rank;
+        }
+    }
+
+    Nan::AsyncWorker* worker = pendingWorkers[best].front().worker;
+    pendingWorkers[best].pop_front();
+    pendingCount--;
+
+    return worker;
+}
+
+
+void ThreadMain(void* data) {
+    uv_thread_t* self = static_cast<uv_thread_t*>(data);
+
+    uv_mutex_lock(&mutex);
+
+    for (;;) {
+        while (pendingCount == 0 && threadCount <= poolSize) {
+            uv_cond_wait(&workAvailable, &mutex);
+        }
+
+        // Surplus threads retire once the pool has been shrunk
+        if (threadCount > poolSize) break;
+
+        Nan::AsyncWorker* worker = PopPendingWorker();
+
+        uv_mutex_unlock(&mutex);
+        worker->Execute();
+        uv_mutex_lock(&mutex);
+
+        completedWorkers.push_back(worker);
+        uv_async_send(&completion);
+    }
+
+    threadCount--;
+    retiredThreads.push_back(self);
+
+    // The wakeup may have been meant for a thread that stays
+    if (pendingCount > 0) uv_cond_signal(&workAvailable);
+
+    uv_async_send(&completion);
+    uv_mutex_unlock(&mutex);
+}
+
+
+// Must be called with the mutex held
+void SpawnThreads() {
+    while (threadCount < poolSize) {
+        uv_thread_t* thread = new uv_thread_t;
+
+        if (uv_thread_create(thread, ThreadMain, thread) != 0) {
+            delete thread;
+            break;
+        }
+
+        threadCount++;
+    }
+}
+
+
+NAUV_WORK_CB(CompleteWorkers) {
+    std::deque<Nan::AsyncWorker*> workers;
+    std::vector<uv_thread_t*> threads;
+
+    uv_mutex_lock(&mutex);
+    workers.swap(completedWorkers);
+    threads.swap(retiredThreads);
+    uv_mutex_unlock(&mutex);
+
+    for (size_t i = 0; i < threads.size(); i++) {
+        uv_thread_join(threads[i]);
+        delete threads[i];
+    }
+
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i]->WorkComplete();
+        workers[i]->Destroy();
+
+        if (--outstandingWorkers == 0) {
+            uv_unref(reinterpret_cast<uv_handle_t*>(&completion));
+        }
+    }
+}
+
+
+}
+
+
+// Queue
+
+
+void ThreadPool::Queue(Nan::AsyncWorker* worker, int priority) {
+    if (outstandingWorkers++ == 0) {
+        uv_ref(reinterpret_cast<uv_handle_t*>(&completion));
+    }
+
+    PendingWorker pending = {worker, uv_hrtime()};
+
+    uv_mutex_lock(&mutex);
+
+    pendingWorkers[priority].push_back(pending);
+    pendingCount++;
+    SpawnThreads();
+    uv_cond_signal(&workAvailable);
+
+    uv_mutex_unlock(&mutex);
+}
+
+
+unsigned ThreadPool::Size() {
+    uv_mutex_lock(&mutex);
+    unsigned size = poolSize;
+    uv_mutex_unlock(&mutex);
+
+    return size;
+}
+
+
+// Wrappers
+
+
+NAN_METHOD(ThreadPool::SetThreadPoolSize) {
+    Nan::HandleScope scope;
+
+    ArgumentHelper arguments(info);
+
+    int size = arguments.GetInt(0);
+    ASSERT_ARGUMENTS(arguments);
+
+    if (size < 1 || size > static_cast<int>(MAX_SIZE)) {
+        return Nan::ThrowRangeError("invalid thread pool size");
+    }
+
+    uv_mutex_lock(&mutex);
+
+    poolSize = size;
+
+    // Threads are only started once there is work; shrinking lets the
+    // surplus threads retire after their current job
+    if (threadCount > 0) SpawnThreads();
+    uv_cond_broadcast(&workAvailable);
+
+    uv_mutex_unlock(&mutex);
+}
+
+
+NAN_METHOD(ThreadPool::ThreadPoolSize) {
+    Nan::HandleScope scope;
+
+    info.GetReturnValue().Set(Nan::New<Integer>(Size()));
+}
+
+
+// Init
+
+
+void ThreadPool::Initialize(Handle<Object> exports) {
+    Nan::HandleScope scope;
+
+    uv_mutex_init(&mutex);
+    uv_cond_init(&workAvailable);
+
+    uv_async_init(uv_default_loop(), &completion, CompleteWorkers);
+    uv_unref(reinterpret_cast<uv_handle_t*>(&completion));
+
+    poolSize = DefaultSize();
+
+    NODE_DEFINE_CONSTANT(exports, PRIORITY_INTERACTIVE);
+    NODE_DEFINE_CONSTANT(exports, PRIORITY_NORMAL);
+    NODE_DEFINE_CONSTANT(exports, PRIORITY_BULK);
+
+    Nan::SetMethod(exports, "setThreadPoolSize", SetThreadPoolSize);
+    Nan::SetMethod(exports, "threadPoolSize", ThreadPoolSize);
+}
+
+
+}
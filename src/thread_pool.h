@@ -0,0 +1,78 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 Christian Speckner <cnspeckn@googlemail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef BINDINGS_THREAD_POOL_H
+#define BINDINGS_THREAD_POOL_H
+
+#include "common.h"
+
+namespace node_libxl {
+
+
+enum {
+    PRIORITY_INTERACTIVE,
+    PRIORITY_NORMAL,
+    PRIORITY_BULK,
+    PRIORITY_COUNT
+};
+
+
+// Worker threads for the async operations, separate from the libuv pool so
+// that long running loads and saves do not block fs, dns or zlib work. Workers
+// run Execute() on a pool thread and complete (WorkComplete() and Destroy())
+// on the main thread, just like with Nan::AsyncQueueWorker. The size
+// defaults to NODE_LIBXL_THREADPOOL_SIZE or 4 and can be changed at any time
+// via xl.setThreadPoolSize.
+//
+// Idle threads pick the queued worker with the best priority class, FIFO
+// within a class. To keep bulk work from starving, every AGING_INTERVAL a
+// worker has been waiting counts as one class better.
+class ThreadPool {
+    public:
+
+        static const unsigned DEFAULT_SIZE = 4;
+        static const unsigned MAX_SIZE = 128;
+        static const uint64_t AGING_INTERVAL = 1000000000; // ns
+
+        static void Initialize(v8::Handle<v8::Object> exports);
+
+        static void Queue(Nan::AsyncWorker* worker,
+            int priority = PRIORITY_NORMAL);
+
+        static unsigned Size();
+
+    protected:
+
+        static NAN_METHOD(SetThreadPoolSize);
+        static NAN_METHOD(ThreadPoolSize);
+
+    private:
+
+        ThreadPool();
+};
+
+
+}
+
+#endif // BINDINGS_THREAD_POOL_H
@@ -0,0 +1,156 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 Christian Speckner <cnspeckn@googlemail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "utf8_string.h"
+
+#include <algorithm>
+
+using namespace v8;
+
+namespace node_libxl {
+
+
+namespace {
+
+
+// Stack-like scratch memory for conversions that do not fit the inline
+// buffer. Allocations are released in LIFO order. The block only grows while
+// it is empty, and requests that do not fit while it is in use get a heap
+// block of their own. JS strings are only converted on the main thread, so
+// one arena serves as the per-thread arena.
+class ScratchArena {
+    public:
+
+        ScratchArena() : block(NULL), blockSize(0), top(0) {}
+
+        char* Allocate(size_t size) {
+            if (top + size <= blockSize) {
+                char* result = block + top;
+                top += size;
+
+                return result;
+            }
+
+            if (top > 0) return new char[size];
+
+            delete[] block;
+            blockSize = std::max(size, 2 * blockSize);
+            block = new char[blockSize];
+            top = size;
+
+            return block;
+        }
+
+        void Release(char* data) {
+            if (data >= block && data < block + blockSize) {
+                top = data - block;
+            } else {
+                delete[] data;
+            }
+        }
+
+    private:
+
+        char* block;
+        size_t blockSize;
+        size_t top;
+};
+
+
+ScratchArena arena;
+
+
+}
+
+
+Utf8String::Utf8String(Local<Value> value) :
+    data(inlineBuffer),
+    capacity(INLINE_SIZE),
+    size(0)
+{
+    Nan::HandleScope scope;
+
+    Local<String> str = value->IsString() ?
+        value.As<String>() : Nan::To<String>(value).ToLocalChecked();
+
+    int length = str->Length();
+
+#if (NODE_MODULE_VERSION > 0x000B)
+
+    if (str->IsOneByte()) {
+        // Latin-1 needs at most two UTF-8 bytes per character; ASCII is
+        // copied as is
+        char* buffer = Reserve(2 * length + 1);
+        char* latin1 = buffer + length;
+
+        str->WriteOneByte(reinterpret_cast<uint8_t*>(latin1), 0, length,
+            String::NO_NULL_TERMINATION);
+
+        char* out = buffer;
+        for (int i = 0; i < length; i++) {
+            unsigned char c = latin1[i];
+
+            if (c < 0x80) {
+                *out++ = c;
+            } else {
+                *out++ = 0xc0 | (c >> 6);
+                *out++ = 0x80 | (c & 0x3f);
+            }
+        }
+
+        *out = '\0';
+        size = static_cast<int>(out - buffer);
+
+        return;
+    }
+
+#endif
+
+    // Every UTF-16 code unit yields at most three UTF-8 bytes
+    char* buffer = Reserve(3 * length + 1);
+
+    size = str->WriteUtf8(buffer, static_cast<int>(capacity), NULL,
+        String::NO_NULL_TERMINATION);
+    buffer[size] = '\0';
+}
+
+
+Utf8String::~Utf8String() {
+    if (data != inlineBuffer) {
+        arena.Release(data);
+    }
+}
+
+
+char* Utf8String::Reserve(size_t required) {
+    if (required > capacity) {
+        data = arena.Allocate(required);
+        capacity = required;
+    }
+
+    return data;
+}
+
+
+}
@@ -0,0 +1,71 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 Christian Speckner <cnspeckn@googlemail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef BINDINGS_UTF8_STRING_H
+#define BINDINGS_UTF8_STRING_H
+
+#include "common.h"
+
+namespace node_libxl {
+
+
+// Drop-in replacement for String::Utf8Value for synchronous calls that avoids
+// heap allocations. Short strings are converted into an inline buffer,
+// longer ones into a scratch arena that is reused across calls. One byte
+// strings are copied directly (Latin-1 characters are transcoded) instead of
+// going through the generic UTF-16 encoder. Instances must be destroyed in
+// reverse order of creation, which scoped locals guarantee.
+class Utf8String {
+    public:
+
+        explicit Utf8String(v8::Local<v8::Value> value);
+        ~Utf8String();
+
+        const char* operator*() const {
+            return data;
+        }
+
+        int length() const {
+            return size;
+        }
+
+    private:
+
+        static const size_t INLINE_SIZE = 128;
+
+        char inlineBuffer[INLINE_SIZE];
+        char* data;
+        size_t capacity;
+        int size;
+
+        char* Reserve(size_t capacity);
+
+        Utf8String(const Utf8String&);
+        const Utf8String& operator=(const Utf8String&);
+};
+
+
+}
+
+#endif // BINDINGS_UTF8_STRING_H
@@ -24,6 +24,11 @@
 
 #include "util.h"
 
+#include <clocale>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
 #include <libxl.h>
 #include <nan.h>
 
@@ -84,35 +89,62 @@ Local<Value> CallStubConstructor(Handle<Function> constructor) {
 }
 
 
-Book* GetBook(Book* book) {
-    return book;
-}
+Local<Object> NewTypedArray(const char* type, uint32_t length) {
+    Nan::EscapableHandleScope scope;
+
+    // Going through the global constructor works across all supported V8
+    // versions, including those without a native typed array API
+    Local<Function> typedArrayConstructor = Nan::GetCurrentContext()->Global()
+        ->Get(Nan::New<String>(type).ToLocalChecked()).As<Function>();
 
+    Handle<Value> argv[1] = {Nan::New<Number>(length)};
 
-Book* GetBook(BookWrapper* bookWrapper) {
-    return bookWrapper->GetBook();
+    return scope.Escape(typedArrayConstructor->NewInstance(1, argv));
 }
 
 
-libxl::Book* UnwrapBook(libxl::Book* book) {
-    return book;
-}
+size_t FormatNumber(double value, char* buffer) {
+    if (value != value) {
+        return sprintf(buffer, "NaN");
+    }
 
+    if (value == std::numeric_limits<double>::infinity() ||
+        value == -std::numeric_limits<double>::infinity())
+    {
+        return sprintf(buffer, value > 0 ? "Infinity" : "-Infinity");
+    }
 
-libxl::Book* UnwrapBook(v8::Local<v8::Value> bookHandle) {
-    Book* book = Book::Unwrap(bookHandle);
+    int length = 0;
 
-    return book ? book->GetWrapped() : NULL;
+    for (int precision = 15; precision <= 17; precision++) {
+        length = sprintf(buffer, "%.*g", precision, value);
+        if (strtod(buffer, NULL) == value) break;
+    }
+
+    // sprintf and strtod use the decimal point of the C locale
+    char point = *localeconv()->decimal_point;
+    if (point != '.') {
+        char* position = strchr(buffer, point);
+        if (position) *position = '.';
+    }
+
+    return length;
 }
 
 
-libxl::Book* UnwrapBook(Book* book) {
-    return book ? book->GetWrapped() : NULL;
+void ResolveRange(libxl::Sheet* sheet, int& rowFirst, int& rowLast,
+    int& colFirst, int& colLast)
+{
+    if (rowFirst == RANGE_DEFAULT) rowFirst = sheet->firstRow();
+    if (rowLast == RANGE_DEFAULT) rowLast = sheet->lastRow() - 1;
+    if (colFirst == RANGE_DEFAULT) colFirst = sheet->firstCol();
+    if (colLast == RANGE_DEFAULT) colLast = sheet->lastCol() - 1;
 }
 
 
-libxl::Book* UnwrapBook(BookWrapper* bookWrapper) {
-    Book* book = bookWrapper->GetBook();
+libxl::Book* UnwrapBook(v8::Local<v8::Value> bookHandle) {
+    Book* book = Book::Unwrap(bookHandle);
+
     return book ? book->GetWrapped() : NULL;
 }
 
@@ -25,6 +25,8 @@
 #ifndef BINDINGS_UTIL
 #define BINDINGS_UTIL
 
+#include <climits>
+
 #include "common.h"
 #include "book.h"
 #include "book_wrapper.h"
@@ -48,14 +50,85 @@ NAN_METHOD(StubConstructor);
 v8::Local<v8::Value> CallStubConstructor(v8::Handle<v8::Function> constructor);
 
 
-Book* GetBook(Book*);
-Book* GetBook(BookWrapper*);
+v8::Local<v8::Object> NewTypedArray(const char* type, uint32_t length);
+
+
+// Formats a number with the first of %.15g, %.16g and %.17g that converts
+// back to the same value, always with '.' as decimal point. Non-finite values
+// are written as NaN, Infinity and -Infinity. Does not touch V8 and may be
+// used on worker threads.
+const size_t NUMBER_BUFFER_SIZE = 32;
+size_t FormatNumber(double value, char* buffer);
+
+
+// Placeholder for range bounds that default to the used area of a sheet.
+// Resolving them needs libxl, so queued async operations resolve them when
+// they run.
+const int RANGE_DEFAULT = INT_MIN;
+
+inline bool IsNegativeBound(int bound) {
+    return bound < 0 && bound != RANGE_DEFAULT;
+}
+
+void ResolveRange(libxl::Sheet* sheet, int& rowFirst, int& rowLast,
+    int& colFirst, int& colLast);
+
+
+// Sheet size limits of libxl (xlsx, xls sheets are smaller), and the largest
+// range copied into native memory by a single call. Larger ranges have to be
+// read in chunks, e.g. via sheet.rows().
+const int MAX_ROWS = 1048576;
+const int MAX_COLS = 16384;
+const uint64_t MAX_RANGE_CELLS = 1 << 24;
+
+// Checks that the first bounds are non-negative and no bound lies beyond the
+// sheet limits. Bounds left at RANGE_DEFAULT are accepted.
+inline bool IsValidRange(int rowFirst, int rowLast, int colFirst,
+    int colLast)
+{
+    return !IsNegativeBound(rowFirst) && !IsNegativeBound(colFirst) &&
+        rowFirst < MAX_ROWS && rowLast < MAX_ROWS &&
+        colFirst < MAX_COLS && colLast < MAX_COLS;
+}
+
+// Number of cells in a range with explicit bounds, 0 if it is empty
+inline uint64_t RangeCellCount(int rowFirst, int rowLast, int colFirst,
+    int colLast)
+{
+    if (rowLast < rowFirst || colLast < colFirst) return 0;
+
+    return (static_cast<uint64_t>(rowLast) - rowFirst + 1) *
+        (static_cast<uint64_t>(colLast) - colFirst + 1);
+}
+
+
+// These run on every call (ASSERT_THIS) and are kept inline
+inline Book* GetBook(Book* book) {
+    return book;
+}
+
+
+inline Book* GetBook(BookWrapper* bookWrapper) {
+    return bookWrapper->GetBook();
+}
+
+
+inline libxl::Book* UnwrapBook(libxl::Book* book) {
+    return book;
+}
 
 
-libxl::Book* UnwrapBook(libxl::Book* book); 
 libxl::Book* UnwrapBook(v8::Local<v8::Value> bookHandle);
-libxl::Book* UnwrapBook(Book* book);
-libxl::Book* UnwrapBook(BookWrapper* bookWrapper);
+
+
+inline libxl::Book* UnwrapBook(Book* book) {
+    return book ? book->GetWrapped() : NULL;
+}
+
+
+inline libxl::Book* UnwrapBook(BookWrapper* bookWrapper) {
+    return UnwrapBook(bookWrapper->GetBook());
+}
 
 template<typename T> Nan::NAN_METHOD_RETURN_TYPE ThrowLibxlError(T wrappedBook) {
     Nan::HandleScope scope;
@@ -46,6 +46,7 @@ template<typename T> class Wrapper : public Nan::ObjectWrap {
     protected:
 
         static Nan::Persistent<v8::Function> constructor;
+        static Nan::Persistent<v8::FunctionTemplate> constructorTemplate;
         T* wrapped;
 
     private:
@@ -61,12 +62,14 @@ template<typename T> class Wrapper : public Nan::ObjectWrap {
 template<typename T> Nan::Persistent<v8::Function> Wrapper<T>::constructor;
 
 
-template<typename T> bool Wrapper<T>::InstanceOf(v8::Handle<v8::Value> object) {
-    Nan::HandleScope scope;
+template<typename T>
+    Nan::Persistent<v8::FunctionTemplate> Wrapper<T>::constructorTemplate;
+
 
+// The template identifies instances directly, no property lookups required
+template<typename T> bool Wrapper<T>::InstanceOf(v8::Handle<v8::Value> object) {
     return object->IsObject() &&
-        object.As<v8::Object>()->GetPrototype()->StrictEquals(
-            Nan::New(constructor)->Get(Nan::New<v8::String>("prototype").ToLocalChecked()));
+        Nan::New(constructorTemplate)->HasInstance(object);
 }
 
 
@@ -0,0 +1,106 @@
+/**
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2013 Christian Speckner <cnspeckn@googlemail.com>
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef BINDINGS_WRAPPER_CACHE_H
+#define BINDINGS_WRAPPER_CACHE_H
+
+#include <map>
+
+#include "common.h"
+
+namespace node_libxl {
+
+
+// Maps libxl objects to their live JS wrappers so that repeated lookups
+// return the same object. Entries are not owned; wrappers remove themselves
+// on destruction. A wrapper whose JS object has already been collected (but
+// whose destructor has not run yet) is reported as missing.
+template<typename K, typename W> class WrapperCache {
+    public:
+
+        WrapperCache() {}
+
+        W* Get(K* key);
+        void Set(K* key, W* wrapper);
+        void Remove(K* key, W* wrapper);
+        void Remove(K* key);
+        void Clear();
+
+    private:
+
+        typedef std::map<K*, W*> EntryMap;
+
+        EntryMap entries;
+
+        WrapperCache(const WrapperCache<K, W>&);
+        const WrapperCache<K, W>& operator=(const WrapperCache<K, W>&);
+};
+
+
+// Implementation
+
+
+template<typename K, typename W> W* WrapperCache<K, W>::Get(K* key) {
+    typename EntryMap::iterator entry = entries.find(key);
+
+    if (entry == entries.end() || entry->second->persistent().IsEmpty()) {
+        return NULL;
+    }
+
+    return entry->second;
+}
+
+
+template<typename K, typename W> void WrapperCache<K, W>::Set(K* key,
+    W* wrapper)
+{
+    entries[key] = wrapper;
+}
+
+
+template<typename K, typename W> void WrapperCache<K, W>::Remove(K* key,
+    W* wrapper)
+{
+    typename EntryMap::iterator entry = entries.find(key);
+
+    // The entry may already belong to a newer wrapper for the same object
+    if (entry != entries.end() && entry->second == wrapper) {
+        entries.erase(entry);
+    }
+}
+
+
+template<typename K, typename W> void WrapperCache<K, W>::Remove(K* key) {
+    entries.erase(key);
+}
+
+
+template<typename K, typename W> void WrapperCache<K, W>::Clear() {
+    entries.clear();
+}
+
+
+}
+
+#endif // BINDINGS_WRAPPER_CACHE_H